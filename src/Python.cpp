@@ -1,13 +1,88 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
 #include "loom/Loom.h"
 #include "topo/Topo.h"
 #include "octi/Octi.h"
-
-
+#include "shared/linegraph/LineGraph.h"
+#include "shared/rendergraph/RenderGraph.h"
+#include "util/geo/output/GeoGraphJsonOutput.h"
+#include "util/json/Writer.h"
 
 namespace py = pybind11;
 
+using shared::linegraph::LineGraph;
+using shared::rendergraph::RenderGraph;
+
+// Native line graph handle. Passing it from one stage to the next avoids
+// serializing the graph to GeoJSON and parsing it again in between.
+struct GraphHandle {
+  std::unique_ptr<LineGraph> graph;
+  util::json::Dict stats;
+
+  static std::unique_ptr<GraphHandle> fromJson(const std::string& json) {
+    std::unique_ptr<GraphHandle> h(new GraphHandle());
+    std::stringstream ss(json);
+    h->graph.reset(new LineGraph());
+    h->graph->readFromJson(&ss);
+    return h;
+  }
+
+  static std::unique_ptr<GraphHandle> fromBinary(const std::string& path) {
+    std::unique_ptr<GraphHandle> h(new GraphHandle());
+    h->graph.reset(new LineGraph());
+    if (!h->graph->readFromBinary(path, 0)) {
+      throw std::runtime_error("Could not read binary graph file " + path);
+    }
+    return h;
+  }
+
+  void toBinary(const std::string& path) const {
+    if (!graph->writeToBinary(path, 0)) {
+      throw std::runtime_error("Could not write binary graph file " + path);
+    }
+  }
+
+  std::string toJson() const {
+    util::geo::output::GeoGraphJsonOutput out;
+    std::ostringstream ss;
+    if (stats.empty()) {
+      out.printLatLng(*graph, ss);
+    } else {
+      out.printLatLng(*graph, ss, stats);
+    }
+    return ss.str();
+  }
+};
+
+// _____________________________________________________________________________
+GraphHandle& runTopoGraph(GraphHandle& h, const std::string& config) {
+  auto cfg = read_topo_config(config);
+  h.stats.clear();
+  h.graph.reset(new LineGraph(run_topo(h.graph.get(), cfg, &h.stats)));
+  return h;
+}
+
+// _____________________________________________________________________________
+GraphHandle& runLoomGraph(GraphHandle& h, const std::string& config) {
+  auto cfg = read_loom_config(config);
+  h.stats.clear();
+  RenderGraph rg(std::move(*h.graph), 5, 1, 5);
+  run_loom(&rg, cfg, &h.stats);
+  h.graph.reset(new LineGraph(std::move(rg)));
+  return h;
+}
+
+// _____________________________________________________________________________
+GraphHandle& runOctiGraph(GraphHandle& h, const std::string& config) {
+  auto cfg = read_octi_config(config);
+  h.stats.clear();
+  h.graph.reset(new LineGraph(run_octi(h.graph.get(), cfg)));
+  return h;
+}
+
 PYBIND11_MODULE(loom, m) {
     m.doc() = R"doc(
         Python bindings for the loom transit map rendering toolkit.
@@ -20,9 +95,54 @@ PYBIND11_MODULE(loom, m) {
             1. run_topo   – clean and topologise raw transit network data
             2. run_loom   – compute line orderings on shared edges
             3. run_octi   – produce an octilinear graph layout
+
+        To chain stages without serializing the graph in between, parse the
+        input once into a LineGraph handle and use the *_graph variants:
+
+            g = loom.LineGraph.from_json(geojson)
+            loom.run_topo_graph(g, topo_cfg)
+            loom.run_loom_graph(g, loom_cfg)
+            loom.run_octi_graph(g, octi_cfg)
+            result = g.to_json()
+
+        All run_* functions release the GIL while they run, so independent
+        pipelines can be processed in parallel Python threads. A single
+        LineGraph handle must not be used by two threads at the same time.
     )doc";
 
-    m.def("run_loom", &run_loom, py::arg("args"),
+    py::class_<GraphHandle>(m, "LineGraph",
+        R"doc(
+            Native handle to a transit line graph held in C++ memory.
+        )doc")
+        .def_static("from_json", &GraphHandle::fromJson, py::arg("json"),
+            py::call_guard<py::gil_scoped_release>(),
+            R"doc(
+                Parse a GeoJSON line graph into a new handle.
+            )doc")
+        .def("to_json", &GraphHandle::toJson,
+            py::call_guard<py::gil_scoped_release>(),
+            R"doc(
+                Serialize the graph (and the statistics of the last stage,
+                if any were written) to a GeoJSON string.
+            )doc")
+        .def_static("from_binary", &GraphHandle::fromBinary, py::arg("path"),
+            py::call_guard<py::gil_scoped_release>(),
+            R"doc(
+                Load a graph from a binary file written by to_binary().
+            )doc")
+        .def("to_binary", &GraphHandle::toBinary, py::arg("path"),
+            py::call_guard<py::gil_scoped_release>(),
+            R"doc(
+                Write the graph to a compact binary file which loads much
+                faster than GeoJSON.
+            )doc")
+        .def("num_nodes", [](const GraphHandle& h) { return h.graph->numNds(); })
+        .def("num_edges", [](const GraphHandle& h) { return h.graph->numEdgs(); })
+        .def("num_lines", [](const GraphHandle& h) { return h.graph->numLines(); });
+
+    m.def("run_loom",
+        py::overload_cast<const std::vector<std::string>&>(&run_loom),
+        py::arg("args"), py::call_guard<py::gil_scoped_release>(),
         R"doc(
             Run the loom line-ordering stage.
 
@@ -37,7 +157,9 @@ PYBIND11_MODULE(loom, m) {
                 int: Exit code (0 on success).
         )doc");
 
-    m.def("run_topo", &run_topo, py::arg("args"),
+    m.def("run_topo",
+        py::overload_cast<const std::vector<std::string>&>(&run_topo),
+        py::arg("args"), py::call_guard<py::gil_scoped_release>(),
         R"doc(
             Run the topo topologisation stage.
 
@@ -53,7 +175,9 @@ PYBIND11_MODULE(loom, m) {
                 int: Exit code (0 on success).
         )doc");
 
-    m.def("run_octi", &run_octi, py::arg("args"),
+    m.def("run_octi",
+        py::overload_cast<const std::vector<std::string>&>(&run_octi),
+        py::arg("args"), py::call_guard<py::gil_scoped_release>(),
         R"doc(
             Run the octi octilinear layout stage.
 
@@ -67,4 +191,46 @@ PYBIND11_MODULE(loom, m) {
             Returns:
                 int: Exit code (0 on success).
         )doc");
-}
\ No newline at end of file
+
+    m.def("run_topo_graph", &runTopoGraph, py::arg("graph"), py::arg("config"),
+        py::return_value_policy::reference,
+        py::call_guard<py::gil_scoped_release>(),
+        R"doc(
+            Run the topo stage on a LineGraph handle, in place.
+
+            Args:
+                graph (LineGraph): the input graph, replaced by the result.
+                config (str): topo configuration as a JSON string.
+
+            Returns:
+                LineGraph: the same handle, for chaining.
+        )doc");
+
+    m.def("run_loom_graph", &runLoomGraph, py::arg("graph"), py::arg("config"),
+        py::return_value_policy::reference,
+        py::call_guard<py::gil_scoped_release>(),
+        R"doc(
+            Run the loom line-ordering stage on a LineGraph handle, in place.
+
+            Args:
+                graph (LineGraph): the input graph, replaced by the result.
+                config (str): loom configuration as a JSON string.
+
+            Returns:
+                LineGraph: the same handle, for chaining.
+        )doc");
+
+    m.def("run_octi_graph", &runOctiGraph, py::arg("graph"), py::arg("config"),
+        py::return_value_policy::reference,
+        py::call_guard<py::gil_scoped_release>(),
+        R"doc(
+            Run the octi layout stage on a LineGraph handle, in place.
+
+            Args:
+                graph (LineGraph): the input graph, replaced by the result.
+                config (str): octi configuration as a JSON string.
+
+            Returns:
+                LineGraph: the same handle, for chaining.
+        )doc");
+}
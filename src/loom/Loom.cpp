@@ -28,31 +28,21 @@ using namespace loom;
 using util::DEBUG;
 using util::ERROR;
 
-std::string run_loom(const std::vector<std::string>& args) {
-
-  if (args.size() != 2) {
-      std::cerr << "Usage: module.run( [<graph_json_file>,<config_json_file>])"<< std::endl;
-      return "";
-  }
-
-  std::stringstream graphStream(args[0]);
-  std::stringstream configFile(args[1]);
-
-  // initialize randomness
-  srand(time(NULL) + rand());
-
+// _____________________________________________________________________________
+loom::config::Config read_loom_config(const std::string& json) {
+  std::stringstream configFile(json);
   loom::config::Config cfg;
   shared::config::ConfigReader cr;
-  
   cr.read(&cfg, &configFile,
           [](loom::config::Config* c) { /* leave defaults */ },
           loom::config::jsonToConfig);
+  return cfg;
+}
 
-
-  LOGTO(DEBUG, std::cerr) << "Reading graph...";
-  shared::rendergraph::RenderGraph g(5, 1, 5);
-
-  g.readFromJson(&graphStream);
+// _____________________________________________________________________________
+void run_loom(shared::rendergraph::RenderGraph* gp,
+              const loom::config::Config& cfg, util::json::Dict* jsonStats) {
+  auto& g = *gp;
 
   LOGTO(DEBUG, std::cerr) << "Optimizing...";
 
@@ -117,11 +107,8 @@ std::string run_loom(const std::vector<std::string>& args) {
     exit(1);
   }
 
-  util::geo::output::GeoGraphJsonOutput out;
-  std::ostringstream outputStream;
-
-  if (cfg.writeStats) {
-    util::json::Dict jsonStats = {
+  if (jsonStats && cfg.writeStats) {
+    *jsonStats = util::json::Dict{
         {"statistics",
          util::json::Dict{
              {"input_num_nodes", stats.numNodesOrig},
@@ -158,6 +145,31 @@ std::string run_loom(const std::vector<std::string>& args) {
              {"best_num_separations", stats.separations},
              {"line_graph_simplification_time", stats.simplificationTime},
              {"best_score", stats.score}}}};
+  }
+}
+
+// _____________________________________________________________________________
+std::string run_loom(const std::vector<std::string>& args) {
+
+  if (args.size() != 2) {
+      std::cerr << "Usage: module.run( [<graph_json_file>,<config_json_file>])"<< std::endl;
+      return "";
+  }
+
+  auto cfg = read_loom_config(args[1]);
+
+  LOGTO(DEBUG, std::cerr) << "Reading graph...";
+  shared::rendergraph::RenderGraph g(5, 1, 5);
+
+  g.readFromJsonCached(args[0], cfg.graphCachePath);
+
+  util::json::Dict jsonStats;
+  run_loom(&g, cfg, &jsonStats);
+
+  util::geo::output::GeoGraphJsonOutput out;
+  std::ostringstream outputStream;
+
+  if (cfg.writeStats) {
     out.printLatLng(g, outputStream, jsonStats);
   } else {
     out.printLatLng(g, outputStream);
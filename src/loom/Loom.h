@@ -3,8 +3,14 @@
 
 #include <string>
 #include <vector>
+#include "loom/config/LoomConfig.h"
+#include "shared/rendergraph/RenderGraph.h"
+#include "util/json/Writer.h"
 
 // Function declarations
+loom::config::Config read_loom_config(const std::string& json);
+void run_loom(shared::rendergraph::RenderGraph* g,
+              const loom::config::Config& cfg, util::json::Dict* stats);
 std::string run_loom(const std::vector<std::string>& args);
 
 #endif  // LOOM_MAIN_H
\ No newline at end of file
@@ -22,6 +22,12 @@ struct Config {
 
   size_t optimRuns = 1;
 
+  // number of components and runs optimized concurrently, 0 for one per core
+  size_t threads = 1;
+
+  // seed for the randomized optimizers, 0 for a random seed
+  uint64_t randomSeed = 0;
+
   bool outOptGraph = false;
 
   bool outputStats = false;
@@ -43,6 +49,9 @@ struct Config {
 
   std::string worldFilePath;
 
+  // binary copy of the input graph, reused on later runs with the same input
+  std::string graphCachePath;
+
   std::string ilpSolver;
 };
 
@@ -50,6 +59,7 @@ struct Config {
 inline void jsonToConfig(const nlohmann::json& jsonObj, Config* cfg) {
   using shared::config::assignIfContains;
   using shared::config::assignIfContainsBool;
+  using shared::config::assignIfContainsCount;
 
   assignIfContainsBool(jsonObj, "no-untangle", [&](bool v){ cfg->untangleGraph = v; });
   assignIfContainsBool(jsonObj, "output-stats", [&](bool v){ cfg->outputStats = v; });
@@ -65,10 +75,13 @@ inline void jsonToConfig(const nlohmann::json& jsonObj, Config* cfg) {
   assignIfContains<std::string>(jsonObj, "ilp-solver", [&](const std::string& v){ cfg->ilpSolver = v; });
   assignIfContains<std::string>(jsonObj, "optim-method", [&](const std::string& v){ cfg->optimMethod = v; });
   assignIfContains<int>(jsonObj, "optim-runs", [&](int v){ cfg->optimRuns = static_cast<size_t>(v); });
+  assignIfContainsCount(jsonObj, "threads", [&](size_t v){ cfg->threads = v; });
+  assignIfContains<uint64_t>(jsonObj, "random-seed", [&](uint64_t v){ cfg->randomSeed = v; });
   assignIfContains<std::string>(jsonObj, "dbg-output-path", [&](const std::string& v){ cfg->dbgPath = v; });
   assignIfContainsBool(jsonObj, "output-optgraph", [&](bool v){ cfg->outOptGraph = v; });
   assignIfContainsBool(jsonObj, "write-stats", [&](bool v){ cfg->writeStats = v; });
   assignIfContainsBool(jsonObj, "from-dot", [&](bool v){ cfg->fromDot = v; });
+  assignIfContains<std::string>(jsonObj, "graph-cache", [&](const std::string& v){ cfg->graphCachePath = v; });
 }
 
 }  // namespace config
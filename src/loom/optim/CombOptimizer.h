@@ -45,6 +45,7 @@ class CombOptimizer : public Optimizer {
                       OptResStats& stats) const;
 
   virtual std::string getName() const { return "comb";}
+  virtual bool usesIlp() const { return true; }
 
  private:
   const ILPEdgeOrderOptimizer _ilpOpt;
@@ -132,8 +132,7 @@ void ExhaustiveOptimizer::initialConfig(const std::set<OptNode*>& g,
 // _____________________________________________________________________________
 void ExhaustiveOptimizer::initialConfig(const std::set<OptNode*>& g,
                                         OptOrderCfg* cfg, bool sorted) const {
-  auto seed = std::chrono::system_clock::now().time_since_epoch().count();
-  auto randEng = std::default_random_engine(seed);
+  auto randEng = getRng();
 
   for (OptNode* n : g) {
     for (OptEdge* e : n->getAdjList()) {
@@ -28,6 +28,7 @@ class ILPOptimizer : public Optimizer {
                               size_t depth, OptResStats& stats) const;
 
   virtual std::string getName() const { return "ilp";}
+  virtual bool usesIlp() const { return true; }
 
  protected:
   const loom::optim::ExhaustiveOptimizer _exhausOpt;
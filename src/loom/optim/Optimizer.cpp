@@ -2,8 +2,12 @@
 // Chair of Algorithms and Data Structures.
 // Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <fstream>
 #include <numeric>
+#include <thread>
 #include "loom/optim/NullOptimizer.h"
 #include "loom/optim/OptGraph.h"
 #include "loom/optim/OptGraphScorer.h"
@@ -36,6 +40,13 @@ using util::geo::DPoint;
 using util::INFO;
 using util::DEBUG;
 
+namespace {
+// the optimization task currently processed by this thread, and the number of
+// random engines already handed out for it
+thread_local uint64_t taskId = 0;
+thread_local uint64_t taskRngCnt = 0;
+}  // namespace
+
 // _____________________________________________________________________________
 OptResStats Optimizer::optimize(RenderGraph* rg) const {
   // create optim graph
@@ -155,75 +166,148 @@ OptResStats Optimizer::optimize(RenderGraph* rg) const {
   double bestScore = std::numeric_limits<double>::infinity();
   OrderCfg bestCfg;
 
-  for (size_t run = 0; run < runs; run++) {
-    OrderCfg c;
-    HierarOrderCfg hc;
+  double maxCompSolSpace = 0;
+  size_t maxCompC = 0;
+  size_t maxNumNodes = 0;
+  size_t maxNumEdges = 0;
+  size_t numM1Comps = 0;
 
-    double t = 0;
-    double maxCompSolSpace = 0;
-    size_t maxCompC = 0;
-    size_t maxNumNodes = 0;
-    size_t maxNumEdges = 0;
-    size_t numM1Comps = 0;
-
-    optResStats.maxNumRowsPerComp = 0;
-    optResStats.maxNumColsPerComp = 0;
-
-    for (const auto& nds : comps) {
-      if (_cfg->outputStats) {
-        size_t maxC = maxCard(nds);
-        double solSp = solutionSpaceSize(nds);
-
-        // skip trivial components
-        if (nds.size() > 2) {
-          if (maxC > maxCompC) maxCompC = maxC;
-          if (solSp > maxCompSolSpace) maxCompSolSpace = solSp;
-          if (solSp == 1) numM1Comps++;
-          if (nds.size() > maxNumNodes) maxNumNodes = nds.size();
-          if (numEdges(nds) > maxNumEdges) maxNumEdges = numEdges(nds);
-
-          LOGTO(INFO, std::cerr)
-              << " (stats) Optimizing subgraph of size " << nds.size()
-              << " with max cardinality = " << maxC
-              << " and solution space size = " << solSp;
-        }
+  std::vector<double> compCosts(comps.size());
+
+  for (size_t i = 0; i < comps.size(); i++) {
+    const auto& nds = comps[i];
+    compCosts[i] = solutionSpaceSize(nds);
+
+    if (_cfg->outputStats) {
+      size_t maxC = maxCard(nds);
+      double solSp = compCosts[i];
+
+      // skip trivial components
+      if (nds.size() > 2) {
+        if (maxC > maxCompC) maxCompC = maxC;
+        if (solSp > maxCompSolSpace) maxCompSolSpace = solSp;
+        if (solSp == 1) numM1Comps++;
+        if (nds.size() > maxNumNodes) maxNumNodes = nds.size();
+        if (numEdges(nds) > maxNumEdges) maxNumEdges = numEdges(nds);
+
+        LOGTO(INFO, std::cerr)
+            << " (stats) Optimizing subgraph of size " << nds.size()
+            << " with max cardinality = " << maxC
+            << " and solution space size = " << solSp;
       }
+    }
+  }
 
-      // this is the implementation of the single edge pruning described in the
-      // publication - simple skip such components
-      // we also skip components with only single edges
-      if (maxC > 1 && nds.size() > 2) {
-        t += optimizeComp(&g, nds, &hc, optResStats);
-      } else {
-        t += nullOpt.optimizeComp(&g, nds, &hc, 0, optResStats);
+  // every (run, component) pair is an independent task which writes into its
+  // own order configuration shard. Tasks are handed out largest solution
+  // space first, the shards are merged in component order afterwards
+  size_t numTasks = runs * comps.size();
+  std::vector<HierarOrderCfg> shards(numTasks);
+  std::vector<double> times(numTasks, 0);
+  std::vector<OptResStats> taskStats(numTasks);
+
+  std::vector<size_t> order(numTasks);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return compCosts[a % comps.size()] > compCosts[b % comps.size()];
+  });
+
+  size_t numThreads = _cfg->threads;
+  if (numThreads == 0) numThreads = std::thread::hardware_concurrency();
+  numThreads = std::max<size_t>(1, std::min(numThreads, numTasks));
+  if (usesIlp()) numThreads = 1;
+
+  std::atomic<size_t> next(0);
+  std::vector<std::exception_ptr> excs(numThreads);
+
+  auto worker = [&](size_t thr) {
+    try {
+      for (size_t i = next++; i < order.size(); i = next++) {
+        size_t task = order[i];
+        const auto& nds = comps[task % comps.size()];
+
+        // random engines only depend on the task, not on the worker
+        taskId = task + 1;
+        taskRngCnt = 0;
+
+        // this is the implementation of the single edge pruning described in
+        // the publication - simple skip such components
+        // we also skip components with only single edges
+        if (maxC > 1 && nds.size() > 2) {
+          times[task] =
+              optimizeComp(&g, nds, &shards[task], taskStats[task]);
+        } else {
+          times[task] = nullOpt.optimizeComp(&g, nds, &shards[task], 0,
+                                             taskStats[task]);
+        }
       }
+    } catch (...) {
+      excs[thr] = std::current_exception();
+      next = order.size();
     }
+  };
+
+  if (numThreads == 1) {
+    worker(0);
+  } else {
+    std::vector<std::thread> thrds;
+    for (size_t t = 0; t < numThreads; t++) thrds.emplace_back(worker, t);
+    for (auto& thr : thrds) thr.join();
+  }
 
-    optResStats.nonTrivialComponents = nonTrivialComponents;
-    optResStats.numCompsSolSpaceOne = numM1Comps;
-    optResStats.maxNumNodesPerComp = maxNumNodes;
-    optResStats.maxNumEdgesPerComp = maxNumEdges;
-    optResStats.maxCardPerComp = maxCompC;
-    optResStats.maxCompSolSpace = maxCompSolSpace;
+  taskId = 0;
 
-    if (_cfg->outputStats) {
-      LOGTO(INFO, std::cerr) << "(stats) Number of nontrivial components: "
-                             << optResStats.nonTrivialComponents;
-      LOGTO(INFO, std::cerr)
-          << "(stats) Number of nontrivial components with sol space size 1: "
-          << optResStats.numCompsSolSpaceOne;
-      LOGTO(INFO, std::cerr)
-          << "(stats) Max number of nodes of all nontrivial components: "
-          << optResStats.maxNumNodesPerComp;
-      LOGTO(INFO, std::cerr)
-          << "(stats) Max number of edges of all nontrivial components: "
-          << optResStats.maxNumEdgesPerComp;
-      LOGTO(INFO, std::cerr)
-          << "(stats) Max cardinality of all nontrivial components: "
-          << optResStats.maxCardPerComp;
-      LOGTO(INFO, std::cerr)
-          << "(stats) Max solution space size of all nontrivial components: "
-          << optResStats.maxCompSolSpace;
+  for (const auto& exc : excs) {
+    if (exc) std::rethrow_exception(exc);
+  }
+
+  optResStats.maxNumRowsPerComp = 0;
+  optResStats.maxNumColsPerComp = 0;
+
+  optResStats.nonTrivialComponents = nonTrivialComponents;
+  optResStats.numCompsSolSpaceOne = numM1Comps;
+  optResStats.maxNumNodesPerComp = maxNumNodes;
+  optResStats.maxNumEdgesPerComp = maxNumEdges;
+  optResStats.maxCardPerComp = maxCompC;
+  optResStats.maxCompSolSpace = maxCompSolSpace;
+
+  if (_cfg->outputStats) {
+    LOGTO(INFO, std::cerr) << "(stats) Number of nontrivial components: "
+                           << optResStats.nonTrivialComponents;
+    LOGTO(INFO, std::cerr)
+        << "(stats) Number of nontrivial components with sol space size 1: "
+        << optResStats.numCompsSolSpaceOne;
+    LOGTO(INFO, std::cerr)
+        << "(stats) Max number of nodes of all nontrivial components: "
+        << optResStats.maxNumNodesPerComp;
+    LOGTO(INFO, std::cerr)
+        << "(stats) Max number of edges of all nontrivial components: "
+        << optResStats.maxNumEdgesPerComp;
+    LOGTO(INFO, std::cerr)
+        << "(stats) Max cardinality of all nontrivial components: "
+        << optResStats.maxCardPerComp;
+    LOGTO(INFO, std::cerr)
+        << "(stats) Max solution space size of all nontrivial components: "
+        << optResStats.maxCompSolSpace;
+  }
+
+  for (size_t run = 0; run < runs; run++) {
+    OrderCfg c;
+    HierarOrderCfg hc;
+
+    double t = 0;
+
+    for (size_t i = 0; i < comps.size(); i++) {
+      size_t task = run * comps.size() + i;
+      mergeShard(shards[task], &hc);
+      t += times[task];
+
+      optResStats.maxNumRowsPerComp =
+          std::max(optResStats.maxNumRowsPerComp,
+                   taskStats[task].maxNumRowsPerComp);
+      optResStats.maxNumColsPerComp =
+          std::max(optResStats.maxNumColsPerComp,
+                   taskStats[task].maxNumColsPerComp);
     }
 
     hc.writeFlatCfg(&c);
@@ -482,6 +566,25 @@ double Optimizer::solutionSpaceSize(const std::set<OptNode*>& g) {
   return ret;
 }
 
+// _____________________________________________________________________________
+void Optimizer::mergeShard(const HierarOrderCfg& shard, HierarOrderCfg* hc) {
+  for (const auto& e : shard) {
+    for (const auto& part : e.second) {
+      auto& ordering = (*hc)[e.first][part.first];
+      ordering.insert(ordering.end(), part.second.begin(), part.second.end());
+    }
+  }
+}
+
+// _____________________________________________________________________________
+std::mt19937 Optimizer::getRng() const {
+  std::seed_seq seq{static_cast<uint32_t>(_seed),
+                    static_cast<uint32_t>(_seed >> 32),
+                    static_cast<uint32_t>(taskId),
+                    static_cast<uint32_t>(taskRngCnt++)};
+  return std::mt19937(seq);
+}
+
 // _____________________________________________________________________________
 double Optimizer::optimizeComp(OptGraph* g, const std::set<OptNode*>& cmp,
                                HierarOrderCfg* c, OptResStats& stats) const {
@@ -2,6 +2,7 @@
 // Chair of Algorithms and Data Structures.
 // Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
+#include <random>
 #include "loom/config/LoomConfig.h"
 #include "loom/optim/OptGraph.h"
 #include "loom/optim/OptGraphScorer.h"
@@ -41,7 +42,9 @@ class Optimizer {
  public:
   Optimizer(const config::Config* cfg,
             const shared::rendergraph::Penalties& pens)
-      : _cfg(cfg), _scorer(pens){};
+      : _cfg(cfg),
+        _scorer(pens),
+        _seed(cfg->randomSeed ? cfg->randomSeed : std::random_device()()){};
 
   virtual OptResStats optimize(shared::rendergraph::RenderGraph* rg) const;
   double optimizeComp(OptGraph* g, const std::set<OptNode*>& cmp,
@@ -77,13 +80,29 @@ class Optimizer {
 
   virtual std::string getName() const = 0;
 
+  // true if components may be solved with an ILP. The solvers are not known
+  // to be thread safe, bring their own threads and may all write the model
+  // to the same MPS file, so such components are never optimized in parallel
+  virtual bool usesIlp() const { return false; }
+
  protected:
   const config::Config* _cfg;
   const OptGraphScorer _scorer;
 
   static std::string prefix(size_t depth);
 
+  // a fresh random engine for a single optimization call, never use the
+  // global C RNG here, optimizers may run concurrently. The engine is seeded
+  // from the configured seed and the current optimization task, so results
+  // do not depend on which worker picked up a component
+  std::mt19937 getRng() const;
+
  private:
+  uint64_t _seed;
+
+  static void mergeShard(const shared::rendergraph::HierarOrderCfg& shard,
+                         shared::rendergraph::HierarOrderCfg* hc);
+
   static OptOrderCfg getOptOrderCfg(
       const shared::rendergraph::OrderCfg&,
       const std::map<const shared::linegraph::LineNode*, OptNode*>& ndMap,
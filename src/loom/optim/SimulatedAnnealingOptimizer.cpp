@@ -3,6 +3,7 @@
 // Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
 #include <algorithm>
+#include <random>
 #include <unordered_map>
 #include "loom/optim/GreedyOptimizer.h"
 #include "loom/optim/SimulatedAnnealingOptimizer.h"
@@ -42,6 +43,9 @@ double SimulatedAnnealingOptimizer::optimizeComp(OptGraph* og,
     greedy.getFlatConfig(g, &cur);
   }
 
+  auto rng = getRng();
+  std::uniform_real_distribution<double> dist(0, 1);
+
   size_t iters = 0;
 
   size_t k = 0;
@@ -65,7 +69,7 @@ double SimulatedAnnealingOptimizer::optimizeComp(OptGraph* og,
 
           double s = getScore(og, edges[i], cur);
 
-          double r = rand() / (RAND_MAX + 1.0);
+          double r = dist(rng);
           double e = exp(-(1.0 * (s - oldScore)) / temp);
 
           if (s < oldScore) {
@@ -8,9 +8,15 @@
   #include <unistd.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <set>
+#include <thread>
 
 #include "3rdparty/json.hpp"
 #include "Octi.h"
@@ -26,11 +32,6 @@
 #include "util/graph/BiDijkstra.h"
 #include "util/json/Writer.h"
 #include "util/log/Log.h"
-#ifdef _OPENMP
-#include <omp.h>
-#else
-#define omp_get_num_procs() 1
-#endif
 
 using std::string;
 using namespace octi;
@@ -115,14 +116,34 @@ std::vector<DPolygon> readObstacleFile(const std::string& p) {
   return ret;
 }
 
+// _____________________________________________________________________________
+void addTotScore(TotalScore& a, const TotalScore& b) {
+  a.score = a.score + b.score;
+  a.ilpstats = a.ilpstats + b.ilpstats;
+  a.gridgraphNumNds += b.gridgraphNumNds;
+  a.gridgraphNumEdgs += b.gridgraphNumEdgs;
+  a.combgraphNumNds += b.combgraphNumNds;
+  a.combgraphNumEdgs += b.combgraphNumEdgs;
+  a.inputgraphNumNds += b.inputgraphNumNds;
+  a.inputgraphNumEdgs += b.inputgraphNumEdgs;
+  a.inputgraphMaxDeg = std::max(a.inputgraphMaxDeg, b.inputgraphMaxDeg);
+  a.numNoEmbeddingFound += b.numNoEmbeddingFound;
+  a.timeMs += b.timeMs;
+}
+
 // _____________________________________________________________________________
 void drawComp(LineGraph& tg, double avgDist, util::json::Array& jsonScores,
               std::vector<LineGraph*>& resultGraphs,
               std::vector<BaseGraph*>& resultGridGraphs, TotalScore& totScore,
-              const config::Config& cfg) {
+              const config::Config& cfg, double timeLimit,
+              const std::atomic<bool>* cancel) {
   Drawing d;
 
-  Octilinearizer oct(cfg.baseGraphType);
+  Octilinearizer oct(cfg.baseGraphType, cfg.corridorCells);
+  oct.setCancelFlag(cancel);
+  oct.setTimeLimit(timeLimit);
+  oct.setLandmarks(cfg.landmarks);
+  oct.setTempering(cfg.optMode == "tempering");
   LineGraph* res = new LineGraph();
   BaseGraph* gg;
 
@@ -183,16 +204,39 @@ void drawComp(LineGraph& tg, double avgDist, util::json::Array& jsonScores,
     time = T_STOP(octi);
     LOGTO(DEBUG, std::cerr)
         << "Schematized using ILP in " << time << " ms, score " << sc.full;
-  } else if ((cfg.optMode == "heur")) {
+  } else if (cfg.seed) {
+    T_START(octi);
+    sc = oct.drawSeeded(cg, box, res, &gg, &d, cfg.pens, gridSize,
+                        cfg.borderRad, cfg.maxGrDist, cfg.orderMethod,
+                        cfg.restrLocSearch, cfg.enfGeoPen, cfg.hananIters,
+                        cfg.obstacles, cfg.heurLocSearchIters, cfg.abortAfter,
+                        cfg.numThreads, *cfg.seed);
+    time = T_STOP(octi);
+
+    LOGTO(DEBUG, std::cerr) << "Schematized from seed drawing in " << time
+                            << " ms, score " << sc.full;
+  } else if (cfg.optMode == "heur" || cfg.optMode == "tempering") {
     T_START(octi);
     sc = oct.draw(cg, box, res, &gg, &d, cfg.pens, gridSize, cfg.borderRad,
                   cfg.maxGrDist, cfg.orderMethod, cfg.restrLocSearch,
                   cfg.enfGeoPen, cfg.hananIters, cfg.obstacles,
-                  cfg.heurLocSearchIters, cfg.abortAfter);
+                  cfg.heurLocSearchIters, cfg.abortAfter, cfg.numThreads);
     time = T_STOP(octi);
 
     LOGTO(DEBUG, std::cerr) << "Schematized using heur approach in " << time
                             << " ms, score " << sc.full;
+  } else if (cfg.optMode == "multilevel") {
+    T_START(octi);
+    sc = oct.drawMultilevel(cg, box, res, &gg, &d, cfg.pens, gridSize,
+                            cfg.borderRad, cfg.maxGrDist, cfg.orderMethod,
+                            cfg.restrLocSearch, cfg.enfGeoPen, cfg.hananIters,
+                            cfg.obstacles, cfg.heurLocSearchIters,
+                            cfg.abortAfter, cfg.numThreads,
+                            cfg.multilevelFactor);
+    time = T_STOP(octi);
+
+    LOGTO(DEBUG, std::cerr) << "Schematized using multilevel approach in "
+                            << time << " ms, score " << sc.full;
   }
 
   if (cfg.writeStats) {
@@ -262,7 +306,8 @@ void drawComp(LineGraph& tg, double avgDist, util::json::Array& jsonScores,
                                   {"max-grid-dist", cfg.maxGrDist}}},
         {"time-ms", time},
         {"iterations", sc.iters},
-        {"procs", omp_get_num_procs()},
+        {"procs", static_cast<size_t>(std::thread::hardware_concurrency())},
+        {"threads", cfg.numThreads},
         {"peak-memory", util::readableSize(maxRss)},
         {"peak-memory-bytes", maxRss},
         {"timestamp", util::json::Int(std::time(0))}};
@@ -288,85 +333,281 @@ void drawComp(LineGraph& tg, double avgDist, util::json::Array& jsonScores,
 }
 
 
-std::string run_octi(const std::vector<std::string>& args) {
+// _____________________________________________________________________________
+octi::config::Config read_octi_config(const std::string& json) {
+  std::stringstream configFile(json);
+  octi::config::Config cfg;
+  shared::config::ConfigReader cr;
+  cr.read(&cfg, &configFile,
+          [](octi::config::Config* c) { /* leave defaults */ },
+          octi::config::jsonToConfig);
 
-    if (args.size() != 2) {
-        std::cerr << "Usage: module.run( [<graph_json_file>,<config_json_file>])"<< std::endl;
-        return "";
+  if (cfg.obstaclePath.size()) {
+    LOGTO(DEBUG, std::cerr) << "Reading obstacle file...";
+    cfg.obstacles = readObstacleFile(cfg.obstaclePath);
+    LOGTO(DEBUG, std::cerr) << "Done. (" << cfg.obstacles.size() << " obst.)";
+  }
+
+  if (cfg.seedPath.size()) {
+    LOGTO(DEBUG, std::cerr) << "Reading seed drawing...";
+    auto seed = std::make_shared<LineGraph>();
+    std::ifstream s(cfg.seedPath);
+    seed->readFromJson(&s);
+    cfg.seed = seed;
+    LOGTO(DEBUG, std::cerr) << "Done. (" << seed->getNds().size() << " nodes)";
+  }
+
+  return cfg;
+}
+
+// _____________________________________________________________________________
+double msSince(std::chrono::steady_clock::time_point t) {
+  return std::chrono::duration<double, std::milli>(
+             std::chrono::steady_clock::now() - t)
+      .count();
+}
+
+// _____________________________________________________________________________
+double timeLeft(double timeLimit, std::chrono::steady_clock::time_point t) {
+  if (timeLimit < 0) return -1;
+  return std::max(0.0, timeLimit - msSince(t));
+}
+
+// _____________________________________________________________________________
+void drawCompConcurrent(LineGraph& tg, double avgDist,
+                        util::json::Array& jsonScores,
+                        std::vector<LineGraph*>& resultGraphs,
+                        std::vector<BaseGraph*>& resultGridGraphs,
+                        TotalScore& totScore, const config::Config& cfg,
+                        double timeLimit) {
+  auto start = std::chrono::steady_clock::now();
+
+  // tries the same grid sizes as the sequential retry in drawComps, each on
+  // a fresh copy of the component like there, but retryConcurrency of them
+  // at once. The coarsest grid that embeds wins,
+  // finer attempts are cancelled as soon as a coarser one succeeded.
+  const size_t MAX_TRIES = 10;
+
+  struct Attempt {
+    LineGraph tg;
+    double dist = 0;
+    std::atomic<bool> cancel{false};
+    bool drawn = false;
+    std::exception_ptr exc;
+
+    util::json::Array jsonScores;
+    std::vector<LineGraph*> resultGraphs;
+    std::vector<BaseGraph*> resultGridGraphs;
+    TotalScore totScore;
+  };
+
+  std::vector<Attempt> attempts(MAX_TRIES);
+
+  double curDist = avgDist;
+  for (auto& a : attempts) {
+    a.dist = curDist;
+    curDist *= 0.85;
+  }
+
+  // the attempts of a batch share the worker threads of a single drawing
+  config::Config attemptCfg = cfg;
+  size_t jobs = cfg.numThreads;
+  if (jobs == 0) jobs = std::thread::hardware_concurrency();
+  attemptCfg.numThreads = std::max<size_t>(1, jobs / cfg.retryConcurrency);
+
+  size_t best = MAX_TRIES;
+
+  for (size_t b = 0; b < MAX_TRIES && best == MAX_TRIES;
+       b += cfg.retryConcurrency) {
+    size_t end = std::min(b + cfg.retryConcurrency, MAX_TRIES);
+    std::vector<std::thread> thrds;
+
+    for (size_t k = b; k < end; k++) {
+      LOGTO(DEBUG, std::cerr) << "Trying grid size " << attempts[k].dist;
+      thrds.emplace_back([&, k]() {
+        auto& a = attempts[k];
+
+        // drawComp modifies the input graph, every attempt needs its own
+        a.tg.addGraph(tg);
+
+        try {
+          drawComp(a.tg, a.dist, a.jsonScores, a.resultGraphs,
+                   a.resultGridGraphs, a.totScore, attemptCfg,
+                   timeLeft(timeLimit, start), &a.cancel);
+          a.drawn = !a.cancel;
+        } catch (const NoEmbeddingFoundExc& exc) {
+          return;
+        } catch (...) {
+          a.exc = std::current_exception();
+          return;
+        }
+
+        // the finer grids are not needed anymore
+        if (a.drawn) {
+          for (size_t j = k + 1; j < end; j++) attempts[j].cancel = true;
+        }
+      });
     }
 
-    std::stringstream graphStream(args[0]);
-    std::stringstream configFile(args[1]);
+    for (auto& thr : thrds) thr.join();
 
-    // initialize randomness
-    srand(static_cast<unsigned>(time(nullptr)) + rand());
+    std::exception_ptr exc;
+    for (size_t k = b; k < end && !exc; k++) exc = attempts[k].exc;
 
-    octi::config::Config cfg;
-    shared::config::ConfigReader cr;
-    cr.read(&cfg, &configFile,
-          [](octi::config::Config* c) { /* leave defaults */ },
-          octi::config::jsonToConfig);
+    if (exc) {
+      for (auto& a : attempts) {
+        for (auto res : a.resultGraphs) delete res;
+        for (auto gg : a.resultGridGraphs) delete gg;
+      }
+      std::rethrow_exception(exc);
+    }
 
-    util::geo::output::GeoGraphJsonOutput out;
+    for (size_t k = b; k < end; k++) {
+      if (attempts[k].drawn && best == MAX_TRIES) best = k;
+    }
+  }
 
-    if (cfg.obstaclePath.size()) {
-        LOGTO(DEBUG, std::cerr) << "Reading obstacle file...";
-        cfg.obstacles = readObstacleFile(cfg.obstaclePath);
-        LOGTO(DEBUG, std::cerr) << "Done. (" << cfg.obstacles.size() << " obst.)";
+  for (size_t k = 0; k < MAX_TRIES; k++) {
+    auto& a = attempts[k];
+    if (k == best) {
+      LOGTO(DEBUG, std::cerr) << "Using grid size " << a.dist;
+      jsonScores.insert(jsonScores.end(), a.jsonScores.begin(),
+                        a.jsonScores.end());
+      resultGraphs.insert(resultGraphs.end(), a.resultGraphs.begin(),
+                          a.resultGraphs.end());
+      resultGridGraphs.insert(resultGridGraphs.end(),
+                              a.resultGridGraphs.begin(),
+                              a.resultGridGraphs.end());
+      addTotScore(totScore, a.totScore);
+    } else {
+      for (auto res : a.resultGraphs) delete res;
+      for (auto gg : a.resultGridGraphs) delete gg;
     }
+  }
+
+  if (best == MAX_TRIES) {
+    if (!cfg.skipOnError) throw NoEmbeddingFoundExc();
+    totScore.numNoEmbeddingFound += 1;
+    jsonScores.push_back(util::json::Dict());
+    LOGTO(WARN, std::cerr) << NoEmbeddingFoundExc().what();
+  }
+}
+
+// _____________________________________________________________________________
+void drawComps(LineGraph* lg, const config::Config& cfg,
+               std::vector<LineGraph*>& resultGraphs,
+               std::vector<BaseGraph*>& resultGridGraphs) {
+  auto start = std::chrono::steady_clock::now();
+
+  LOGTO(DEBUG, std::cerr) << "Planarizing graph...";
+  T_START(planarize);
+  lg->topologizeIsects();
+  LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(planarize) << "ms)";
+
+  std::vector<LineGraph> comps = lg->distConnectedComponents(10000, false);
+
+  util::json::Array jsonScores;
+  TotalScore totScore;
+  size_t i = 0;
+
+  // the time budget is split across the components by their number of
+  // edges, time not used by a component goes to the following ones
+  size_t edgsLeft = 0;
+  for (const auto& tg : comps) edgsLeft += tg.numEdgs();
+
+  for (auto& tg : comps) {
+    LOGTO(DEBUG, std::cerr) << "@ component " << i++;
+    double avgDist = avgStatDist(tg);
+
+    auto compStart = std::chrono::steady_clock::now();
+    double timeLimit = timeLeft(cfg.timeLimit, start);
+    if (timeLimit > 0 && edgsLeft > 0) {
+      timeLimit = timeLimit * tg.numEdgs() / edgsLeft;
+    }
+    edgsLeft -= tg.numEdgs();
+
+    if (cfg.retryOnError && cfg.retryConcurrency > 1) {
+      drawCompConcurrent(tg, avgDist, jsonScores, resultGraphs,
+                         resultGridGraphs, totScore, cfg, timeLimit);
+      continue;
+    }
+
+    double curDist = avgDist;
+    size_t tries = 0;
+    const size_t MAX_TRIES = 10;
+
+    while (tries < MAX_TRIES) {
+      // drawComp modifies the input graph, every try starts from the
+      // original component, like the concurrent tries do
+      LineGraph tryTg;
+      tryTg.addGraph(tg);
+
+      try {
+        drawComp(tryTg, curDist, jsonScores, resultGraphs, resultGridGraphs,
+                 totScore, cfg, timeLeft(timeLimit, compStart), 0);
+        break;
+      } catch (const NoEmbeddingFoundExc& exc) {
+        if (cfg.retryOnError && tries < MAX_TRIES) {
+          curDist *= 0.85;
+          tries++;
+          LOGTO(WARN, std::cerr) << "Retrying with grid size " << curDist;
+          continue;
+        }
+        if (cfg.skipOnError) {
+          totScore.numNoEmbeddingFound += 1;
+          jsonScores.push_back(util::json::Dict());
+          LOGTO(WARN, std::cerr) << exc.what();
+          break;
+        }
+        throw;
+      }
+    }
+  }
+}
+
+// _____________________________________________________________________________
+LineGraph run_octi(LineGraph* lg, const config::Config& cfg) {
+  std::vector<LineGraph*> resultGraphs;
+  std::vector<BaseGraph*> resultGridGraphs;
+
+  drawComps(lg, cfg, resultGraphs, resultGridGraphs);
+
+  LineGraph ret;
+  for (auto res : resultGraphs) {
+    ret.addGraph(*res);
+    delete res;
+  }
+  for (auto gg : resultGridGraphs) delete gg;
+
+  return ret;
+}
+
+// _____________________________________________________________________________
+std::string run_octi(const std::vector<std::string>& args) {
+
+    if (args.size() != 2) {
+        std::cerr << "Usage: module.run( [<graph_json_file>,<config_json_file>])"<< std::endl;
+        return "";
+    }
+
+    auto cfg = read_octi_config(args[1]);
 
     LOGTO(DEBUG, std::cerr) << "Reading graph file...";
     T_START(read);
     shared::linegraph::LineGraph lg;
 
-    lg.readFromJson(&graphStream);
+    lg.readFromJsonCached(args[0], cfg.graphCachePath);
 
     LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(read) << "ms)";
 
-    LOGTO(DEBUG, std::cerr) << "Planarizing graph...";
-    T_START(planarize);
-    lg.topologizeIsects();
-    LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(planarize) << "ms)";
-
-    std::vector<shared::linegraph::LineGraph> comps = lg.distConnectedComponents(10000, false);
-
-    // reuse octi main's processing by calling existing helpers (drawComp etc.)
-    // For brevity we re-run the same high-level flow as original main.
-    util::json::Array jsonScores;
     std::vector<shared::linegraph::LineGraph*> resultGraphs;
     std::vector<octi::basegraph::BaseGraph*> resultGridGraphs;
 
-    TotalScore totScore;
-    size_t i = 0;
-
-    for (auto& tg : comps) {
-        LOGTO(DEBUG, std::cerr) << "@ component " << i++;
-        double avgDist = avgStatDist(tg);
-        double curDist = avgDist;
-        size_t tries = 0;
-        const size_t MAX_TRIES = 10;
-
-        while (tries < MAX_TRIES) {
-            try {
-                drawComp(tg, curDist, jsonScores, resultGraphs, resultGridGraphs, totScore, cfg);
-                break;
-            } catch (const NoEmbeddingFoundExc& exc) {
-                if (cfg.retryOnError && tries < MAX_TRIES) {
-                    curDist *= 0.85;
-                    tries++;
-                    LOGTO(WARN, std::cerr) << "Retrying with grid size " << curDist;
-                    continue;
-                }
-                if (cfg.skipOnError) {
-                    totScore.numNoEmbeddingFound += 1;
-                    jsonScores.push_back(util::json::Dict());
-                    LOGTO(WARN, std::cerr) << exc.what();
-                    break;
-                }
-                LOG(ERROR) << exc.what();
-                return "";
-            }
-        }
+    try {
+        drawComps(&lg, cfg, resultGraphs, resultGridGraphs);
+    } catch (const NoEmbeddingFoundExc& exc) {
+        LOG(ERROR) << exc.what();
+        return "";
     }
 
     util::geo::output::GeoGraphJsonOutput gout;
@@ -1,6 +1,7 @@
 #ifndef OCTI_MAIN_H
 #define OCTI_MAIN_H
 
+#include <atomic>
 #include <string>
 #include <vector>
 #include "shared/linegraph/LineGraph.h"
@@ -18,6 +19,13 @@ void drawComp(shared::linegraph::LineGraph& tg, double avgDist,
               std::vector<util::json::Val>& jsonScores,
               std::vector<shared::linegraph::LineGraph*>& resultGraphs,
               std::vector<octi::basegraph::BaseGraph*>& resultGridGraphs,
-              TotalScore& totScore, const octi::config::Config& cfg);
+              TotalScore& totScore, const octi::config::Config& cfg,
+              double timeLimit, const std::atomic<bool>* cancel);
+void drawComps(shared::linegraph::LineGraph* lg, const octi::config::Config& cfg,
+               std::vector<shared::linegraph::LineGraph*>& resultGraphs,
+               std::vector<octi::basegraph::BaseGraph*>& resultGridGraphs);
+octi::config::Config read_octi_config(const std::string& json);
+shared::linegraph::LineGraph run_octi(shared::linegraph::LineGraph* lg,
+                                      const octi::config::Config& cfg);
 std::string run_octi(const std::vector<std::string>& args);
 #endif  // OCTI_MAIN_H
\ No newline at end of file
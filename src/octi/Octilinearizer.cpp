@@ -3,15 +3,21 @@
 // Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <mutex>
+#include <random>
 #include <thread>
 #include "ilp/ILPGridOptimizer.h"
 #include "octi/Octilinearizer.h"
+#include "octi/Seed.h"
 #include "octi/basegraph/BaseGraph.h"
 #include "octi/basegraph/ConvexHullOctiGridGraph.h"
 #include "octi/basegraph/GridGraph.h"
+#include "octi/basegraph/GridRouter.h"
 #include "octi/basegraph/HexGridGraph.h"
 #include "octi/basegraph/NodeCost.h"
+#include "octi/basegraph/OctiCorridorGraph.h"
 #include "octi/basegraph/OctiGridGraph.h"
 #include "octi/basegraph/OctiHananGraph.h"
 #include "octi/basegraph/OctiQuadTree.h"
@@ -68,7 +74,8 @@ Score Octilinearizer::drawILP(
     // important: always use restrLocSearch here!
     auto score = draw(cg, box, &tmpOutTg, &gg, &drawing, pensCpy, gridSize,
                       borderRad, maxGrDist, orderMethod, true, enfGeoPen,
-                      hananIters, {}, 100, std::numeric_limits<size_t>::max());
+                      hananIters, {}, 100, std::numeric_limits<size_t>::max(),
+                      1);
     if (score.violations) throw NoEmbeddingFoundExc();
     LOGTO(DEBUG, std::cerr) << "Presolving finished.";
   } catch (const NoEmbeddingFoundExc& exc) {
@@ -85,9 +92,10 @@ Score Octilinearizer::drawILP(
     auto edges = getOrdering(cg, OrderMethod::NUM_LINES);
     LOGTO(DEBUG, std::cerr) << "Writing geopens for " << edges.size() << " edges";
     T_START(geopens);
-    for (auto cmbEdg : edges) {
-      gg->writeGeoCoursePens(cmbEdg, &enfGeoPens, enfGeoPen);
-    }
+    size_t jobs = numThreads;
+    if (numThreads <= 0) jobs = std::thread::hardware_concurrency();
+    if (jobs == 0) jobs = 1;
+    writeGeoPens(gg, edges, enfGeoPen, jobs, &enfGeoPens);
     LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(geopens) << "ms)";
     geoPens = &enfGeoPens;
   }
@@ -103,6 +111,15 @@ Score Octilinearizer::drawILP(
 
   ilp::ILPGridOptimizer ilpoptim;
 
+  if (_hasDeadline) {
+    // the solver returns its best solution so far after the time limit
+    int left = std::chrono::duration_cast<std::chrono::seconds>(
+                   _deadline - std::chrono::steady_clock::now())
+                   .count();
+    if (left < 1) left = 1;
+    if (timeLim < 0 || left < timeLim) timeLim = left;
+  }
+
   *stats =
       ilpoptim.optimize(gg, cg, &drawing, maxGrDist, noSolve, geoPens, timeLim,
                         cacheDir, cacheThreshold, numThreads, solverStr, path);
@@ -125,17 +142,148 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
                            OrderMethod orderMethod, bool restrLocSearch,
                            double enfGeoPen, size_t hananIters,
                            const std::vector<util::geo::Polygon<double>>& obstacles,
-                           size_t locSearchIters, size_t abortAfter) {
-  size_t jobs = 4;
+                           size_t locSearchIters, size_t abortAfter,
+                           size_t numThreads) {
+  return draw(cg, box, outTg, retGg, dOut, pens, gridSize, borderRad,
+              maxGrDist, orderMethod, restrLocSearch, enfGeoPen, hananIters,
+              obstacles, locSearchIters, abortAfter, numThreads, 0);
+}
+
+// _____________________________________________________________________________
+Score Octilinearizer::drawMultilevel(
+    const CombGraph& cg, const DBox& box, LineGraph* outTg, BaseGraph** retGg,
+    Drawing* dOut, const Penalties& pens, double gridSize, double borderRad,
+    double maxGrDist, OrderMethod orderMethod, bool restrLocSearch,
+    double enfGeoPen, size_t hananIters,
+    const std::vector<util::geo::Polygon<double>>& obstacles,
+    size_t locSearchIters, size_t abortAfter, size_t numThreads,
+    size_t coarseFactor) {
+  if (coarseFactor < 2) coarseFactor = 2;
+  double coarseGridSize = gridSize * coarseFactor;
+
+  BaseGraph* coarseGg = 0;
+  Drawing coarse;
+  LineGraph coarseOutTg;
+
+  LOGTO(DEBUG, std::cerr) << "Drawing on coarse grid with cell size "
+                          << coarseGridSize << "...";
+
+  try {
+    draw(cg, box, &coarseOutTg, &coarseGg, &coarse, pens, coarseGridSize,
+         borderRad, maxGrDist, orderMethod, restrLocSearch, enfGeoPen,
+         hananIters, obstacles, locSearchIters, abortAfter, numThreads);
+  } catch (const NoEmbeddingFoundExc& exc) {
+    LOGTO(DEBUG, std::cerr) << "No coarse drawing found, using full grid.";
+    return draw(cg, box, outTg, retGg, dOut, pens, gridSize, borderRad,
+                maxGrDist, orderMethod, restrLocSearch, enfGeoPen, hananIters,
+                obstacles, locSearchIters, abortAfter, numThreads);
+  }
+
+  LOGTO(DEBUG, std::cerr) << "Refining coarse drawing with score "
+                          << coarse.score() << "...";
+
+  // the corridor extends one coarse cell to each side of the coarse path
+  Prior prior;
+  prior.corridorRad = coarseGridSize;
+
+  for (const auto& p : coarse.getEdgPaths()) {
+    prior.edgs[p.first] = coarseGg->geomFromPath(p.second).getLine();
+  }
+
+  for (auto nd : cg.getNds()) {
+    if (nd->getDeg() == 0) continue;
+    prior.nds[nd] = *coarse.getGrNd(nd)->pl().getGeom();
+  }
+
+  delete coarseGg;
+
+  try {
+    return draw(cg, box, outTg, retGg, dOut, pens, gridSize, borderRad,
+                maxGrDist, orderMethod, restrLocSearch, enfGeoPen, hananIters,
+                obstacles, locSearchIters, abortAfter, numThreads, &prior);
+  } catch (const NoEmbeddingFoundExc& exc) {
+    LOGTO(DEBUG, std::cerr) << "No drawing found in corridors, using full "
+                               "grid.";
+    return draw(cg, box, outTg, retGg, dOut, pens, gridSize, borderRad,
+                maxGrDist, orderMethod, restrLocSearch, enfGeoPen, hananIters,
+                obstacles, locSearchIters, abortAfter, numThreads);
+  }
+}
+
+// _____________________________________________________________________________
+Score Octilinearizer::drawSeeded(
+    const CombGraph& cg, const DBox& box, LineGraph* outTg, BaseGraph** retGg,
+    Drawing* dOut, const Penalties& pens, double gridSize, double borderRad,
+    double maxGrDist, OrderMethod orderMethod, bool restrLocSearch,
+    double enfGeoPen, size_t hananIters,
+    const std::vector<util::geo::Polygon<double>>& obstacles,
+    size_t locSearchIters, size_t abortAfter, size_t numThreads,
+    const LineGraph& seed) {
+  Seed s(cg, seed);
+
+  size_t numNds = 0, numEdgs = 0;
+  for (auto nd : cg.getNds()) {
+    if (nd->getDeg() == 0) continue;
+    numNds++;
+    numEdgs += nd->getDeg();
+  }
+  numEdgs /= 2;
+
+  LOGTO(DEBUG, std::cerr) << "Seed matches " << s.getNds().size() << " of "
+                          << numNds << " nodes and " << s.getEdgs().size()
+                          << " of " << numEdgs << " edges.";
+
+  if (s.getNds().empty()) {
+    LOGTO(DEBUG, std::cerr) << "Nothing to keep from seed, drawing from "
+                               "scratch.";
+    return draw(cg, box, outTg, retGg, dOut, pens, gridSize, borderRad,
+                maxGrDist, orderMethod, restrLocSearch, enfGeoPen, hananIters,
+                obstacles, locSearchIters, abortAfter, numThreads);
+  }
+
+  // the seed was drawn on a grid of about the same size, but possibly with
+  // a different offset, so a corridor two cells wide always contains the
+  // nearest grid path
+  Prior prior;
+  prior.nds = s.getNds();
+  prior.edgs = s.getEdgs();
+  prior.corridorRad = 2 * gridSize;
+  prior.local = true;
+
+  try {
+    return draw(cg, box, outTg, retGg, dOut, pens, gridSize, borderRad,
+                maxGrDist, orderMethod, restrLocSearch, enfGeoPen, hananIters,
+                obstacles, locSearchIters, abortAfter, numThreads, &prior);
+  } catch (const NoEmbeddingFoundExc& exc) {
+    LOGTO(DEBUG, std::cerr) << "No drawing found close to seed, drawing from "
+                               "scratch.";
+    return draw(cg, box, outTg, retGg, dOut, pens, gridSize, borderRad,
+                maxGrDist, orderMethod, restrLocSearch, enfGeoPen, hananIters,
+                obstacles, locSearchIters, abortAfter, numThreads);
+  }
+}
+
+// _____________________________________________________________________________
+Score Octilinearizer::draw(
+    const CombGraph& cg, const DBox& box, LineGraph* outTg, BaseGraph** retGg,
+    Drawing* dOut, const Penalties& pens, double gridSize, double borderRad,
+    double maxGrDist, OrderMethod orderMethod, bool restrLocSearch,
+    double enfGeoPen, size_t hananIters,
+    const std::vector<util::geo::Polygon<double>>& obstacles,
+    size_t locSearchIters, size_t abortAfter, size_t numThreads,
+    const Prior* prior) {
+  // every job works on its own grid graph, the grid topology is only built
+  // once and shared with the other jobs
+  size_t jobs = numThreads;
+  if (jobs == 0) jobs = std::thread::hardware_concurrency();
+  if (jobs == 0) jobs = 1;
+
   std::vector<BaseGraph*> ggs(jobs);
 
-  LOGTO(DEBUG, std::cerr) << "Creating grid graphs... ";
+  LOGTO(DEBUG, std::cerr) << "Creating grid graph... ";
   T_START(ggraph);
-#pragma omp parallel for
-  for (int i = 0; i < (int)jobs; i++) {
-    ggs[i] = newBaseGraph(box, cg, gridSize, borderRad, hananIters, pens);
-    ggs[i]->init();
-  }
+  ggs[0] = newBaseGraph(box, cg, gridSize, borderRad, hananIters, pens);
+  ggs[0]->init();
 
   LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(ggraph) << "ms)";
 
@@ -154,12 +302,7 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
   if (enfGeoPen > 0) {
     LOGTO(DEBUG, std::cerr) << "Writing geopens for " << edges.size() << " edges";
     T_START(geopens);
-    size_t i = 0;
-    for (auto cmbEdg : edges) {
-      i++;
-      LOGTO(DEBUG, std::cerr) << "@ " << i << "/" << edges.size();
-      ggs[0]->writeGeoCoursePens(cmbEdg, &enfGeoPens, enfGeoPen);
-    }
+    writeGeoPens(ggs[0], edges, enfGeoPen, jobs, &enfGeoPens);
     LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(geopens) << "ms)";
     geoPens = &enfGeoPens;
   }
@@ -167,15 +310,46 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
   if (obstacles.size()) {
     LOGTO(DEBUG, std::cerr) << "Writing obstacles... ";
     T_START(obstacles);
-    for (auto gg : ggs)
-      for (const auto& obst : obstacles) gg->addObstacle(obst);
+    ggs[0]->addObstacles(obstacles);
     LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(obstacles) << "ms)";
   }
 
+  if (_landmarks) {
+    // after the obstacles, so that the bounds already route around them
+    LOGTO(DEBUG, std::cerr) << "Computing " << _landmarks << " landmarks... ";
+    T_START(landmarks);
+    ggs[0]->initLandmarks(_landmarks);
+    LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(landmarks) << "ms)";
+  }
+
+  CorridorMap corrs;
+  const CorridorMap* corridors = 0;
+
+  // start positions of the nodes
+  SettledPos initPos;
+
+  if (prior) {
+    LOGTO(DEBUG, std::cerr) << "Projecting prior drawing... ";
+    T_START(project);
+    for (const auto& p : prior->edgs) {
+      ggs[0]->writeCorridor(p.first, p.second, prior->corridorRad, &corrs);
+    }
+
+    for (const auto& p : prior->nds) {
+      auto cands = ggs[0]->getGridNdCands(p.second, maxGrDist);
+      if (!cands.empty()) initPos[p.first] = cands.top().n;
+    }
+
+    corridors = &corrs;
+    LOGTO(DEBUG, std::cerr) << "Done. (" << T_STOP(project) << "ms)";
+  }
+
+  // forks copy the current edge costs, including the obstacle costs
+  for (size_t i = 1; i < jobs; i++) ggs[i] = ggs[0]->fork();
+
   // this is the best drawing
   Drawing drawing(ggs[0]);
-
-  // try our default edge ordering first, without any randomization
+  std::mutex drawingMtx;
 
   std::vector<OrderMethod> methods = {
       OrderMethod::NUM_LINES,     OrderMethod::LENGTH,
@@ -184,49 +358,86 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
 
   if (orderMethod != OrderMethod::ALL) {
     methods = {orderMethod};
+  } else if (prior && prior->local) {
+    // most edges are already fixed by their prior paths, trying other
+    // orderings would gain little
+    methods = {OrderMethod::NUM_LINES};
   }
 
-  std::vector<std::vector<OrderMethod>> batches(jobs);
-  for (size_t i = 0; i < methods.size(); i++) {
-    batches[i % jobs].push_back(methods[i]);
-  }
+  // the orderings form a portfolio: every job takes the next untried one, and
+  // the score of the best drawing so far is shared as a bound, so that
+  // losing orderings are given up early. Jobs that would otherwise idle in
+  // the last round try random perturbations. Perturbation i starts from the
+  // ordering of method i % |methods| and is seeded with i, not from the best
+  // ordering so far, which would depend on thread timing. The bound only
+  // drops orderings that cannot beat the best one, so apart from exact score
+  // ties the result does not depend on timing either.
+  size_t numPerturbs = (jobs - methods.size() % jobs) % jobs;
+  size_t numTasks = methods.size() + numPerturbs;
+
+  std::atomic<size_t> nextTask(0);
+  std::atomic<double> bestScore(INF);
+  size_t bestTask = numTasks;
 
   LOGTO(DEBUG, std::cerr) << "Searching initial drawing... ";
 
-#pragma omp parallel for
-  for (int btch = 0; btch < (int)jobs; btch++) {
-    for (OrderMethod meth : batches[btch]) {
+  parallelFor(jobs, [&](size_t btch) {
+    for (size_t task = nextTask++; task < numTasks; task = nextTask++) {
+      if (cancelled()) break;
+      if (bestScore != INF && timedOut()) break;
+
       T_START(draw);
       Drawing drawingCp(ggs[btch]);
+      std::vector<CombEdge*> iterOrder;
+      std::string name;
 
-      // get a randomized ordering
-      std::vector<CombEdge*> iterOrder = getOrdering(cg, meth);
+      if (task < methods.size()) {
+        iterOrder = getOrdering(cg, methods[task]);
+        name = "Try " + std::to_string(methods[task]);
+      } else {
+        size_t i = task - methods.size();
+        iterOrder = getOrdering(cg, methods[i % methods.size()]);
 
-      double bestScoreSoFar = 0;
+        std::mt19937 rng(i);
+        perturb(&iterOrder, &rng);
+        name = "Perturbation " + std::to_string(i);
+      }
 
-#pragma omp critical
-      { bestScoreSoFar = drawing.score(); }
+      if (prior && prior->local) {
+        // edges with a prior path first, the others are routed around them
+        std::stable_partition(
+            iterOrder.begin(), iterOrder.end(),
+            [prior](const CombEdge* e) { return prior->edgs.count(e); });
+      }
 
-      auto status = draw(iterOrder, ggs[btch], &drawingCp, bestScoreSoFar,
-                         maxGrDist, geoPens, abortAfter);
+      auto status = draw(iterOrder, initPos, ggs[btch], &drawingCp, INF,
+                         maxGrDist, geoPens, corridors, abortAfter, &bestScore);
 
       drawingCp.eraseFromGrid(ggs[btch]);
 
-      statLine(status, std::string("Try ") + std::to_string(meth), drawingCp,
-               T_STOP(draw), "*");
+      statLine(status, name, drawingCp, T_STOP(draw), "*");
 
-#pragma omp critical
       {
-        if (status == DRAWN && drawingCp.score() < drawing.score()) {
+        std::lock_guard<std::mutex> lock(drawingMtx);
+        // ties go to the earlier task, independent of which finished first
+        if (status == DRAWN &&
+            (drawingCp.score() < drawing.score() ||
+             (drawingCp.score() == drawing.score() && task < bestTask))) {
           drawing = drawingCp;
+          bestTask = task;
+          bestScore = drawing.score();
         } else {
           drawingCp.crumble();
         }
       }
     }
-  }
+  });
 
-  if (drawing.score() == INF) throw NoEmbeddingFoundExc();
+  if (drawing.score() == INF) {
+    for (size_t i = 1; i < jobs; i++) delete ggs[i];
+    delete ggs[0];
+    throw NoEmbeddingFoundExc();
+  }
 
   LOGTO(DEBUG, std::cerr) << "Done.";
 
@@ -241,25 +452,41 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
   // dont use local search if abortAfter is set
   if (abortAfter != std::numeric_limits<size_t>::max()) LOCAL_SEARCH_ITERS = 0;
 
-  std::vector<std::vector<CombNode*>> batchesLoc(jobs);
-  size_t c = 0;
+  std::vector<CombNode*> locNds;
   for (auto nd : cg.getNds()) {
     if (nd->getDeg() == 0) continue;
-    batchesLoc[c % jobs].push_back(nd);
-    c++;
+    if (prior && prior->local && !nearChange(nd, *prior)) continue;
+    locNds.push_back(nd);
+  }
+
+  std::vector<std::vector<CombNode*>> batchesLoc(jobs);
+  for (size_t i = 0; i < locNds.size(); i++) {
+    batchesLoc[i % jobs].push_back(locNds[i]);
+  }
+
+  size_t sweeps = 0;
+  if (_tempering && LOCAL_SEARCH_ITERS) {
+    // the greedy local search below then only polishes the best replica
+    sweeps = temper(locNds, ggs, &drawing, LOCAL_SEARCH_ITERS, restrLocSearch,
+                    maxGrDist, geoPens, corridors);
   }
 
   for (; iters < LOCAL_SEARCH_ITERS; iters++) {
+    if (cancelled() || timedOut()) break;
     T_START(iter);
     std::vector<Drawing> bestFrIters(jobs);
 
-#pragma omp parallel for
-    for (int btch = 0; btch < (int)jobs; btch++) {
-      for (auto a : batchesLoc[btch]) {
-        Drawing drawingCp = drawing;
+    parallelFor(jobs, [&](size_t btch) {
+      // a single working copy per batch, all candidate moves are done in
+      // transactions and rolled back afterwards
+      Drawing drawingCp = drawing;
 
-        // use the batches grid graph
-        drawingCp.setBaseGraph(ggs[btch]);
+      // use the batches grid graph
+      drawingCp.setBaseGraph(ggs[btch]);
+
+      for (auto a : batchesLoc[btch]) {
+        if (cancelled() || timedOut()) break;
+        drawingCp.begin();
 
         // reverting a
         std::vector<CombEdge*> test;
@@ -289,23 +516,30 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
             if (gridD >= maxDis) continue;
           }
 
-          Drawing run = drawingCp;
+          drawingCp.begin();
 
           // we can use bestFromIter.score() as the limit for the shortest
           // path computation, as we can already do at least as good.
           auto error =
-              draw(test, p, ggs[btch], &run, bestFrIters[btch].score(),
-                   maxGrDist, geoPens, std::numeric_limits<size_t>::max());
+              draw(test, p, ggs[btch], &drawingCp, bestFrIters[btch].score(),
+                   maxGrDist, geoPens, corridors,
+                   std::numeric_limits<size_t>::max(), 0);
 
-          if (!error && bestFrIters[btch].score() > run.score()) {
-            bestFrIters[btch] = run;
+          if (!error && bestFrIters[btch].score() > drawingCp.score()) {
+            bestFrIters[btch] = drawingCp;
           }
 
           // reset grid
-          for (auto ce : a->getAdjList()) run.eraseFromGrid(ce, ggs[btch]);
+          for (auto ce : a->getAdjList()) {
+            drawingCp.eraseFromGrid(ce, ggs[btch]);
+          }
           if (ggs[btch]->isSettled(a)) ggs[btch]->unSettleNd(a);
+
+          drawingCp.rollback();
         }
 
+        drawingCp.rollback();
+
         ggs[btch]->settleNd(const_cast<GridNode*>(ggs[btch]->getGrNdById(
                                 drawing.getGrNd(a)->pl().getId())),
                             a);
@@ -313,7 +547,7 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
         // re-settle edges
         for (auto ce : a->getAdjList()) drawing.applyToGrid(ce, ggs[btch]);
       }
-    }
+    });
 
     size_t bestCore = 0;
     double bestScore = std::numeric_limits<double>::infinity();
@@ -324,6 +558,9 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
       }
     }
 
+    // all batches were interrupted before their first node
+    if (bestScore == INF) break;
+
     double imp = (drawing.score() - bestFrIters[bestCore].score());
     LOGTO(DEBUG, std::cerr)
         << " ++ Iter " << iters << ", prev " << drawing.score() << ", next "
@@ -347,16 +584,196 @@ Score Octilinearizer::draw(const CombGraph& cg, const DBox& box,
                           << ", mv costs: " << fullScore.move
                           << ", dense costs: " << fullScore.dense;
 
+  for (size_t i = 1; i < jobs; i++) delete ggs[i];
+
   *retGg = ggs[0];
   *dOut = drawing;
 
   // the drawing might still have another internal grid graph, make sure they
   // match (this is important for drawILP)
   dOut->setBaseGraph(ggs[0]);
-  fullScore.iters = iters;
+  fullScore.iters = iters + sweeps;
   return fullScore;
 }
 
+// _____________________________________________________________________________
+size_t Octilinearizer::temper(const std::vector<CombNode*>& nds,
+                              const std::vector<BaseGraph*>& ggs,
+                              Drawing* drawing, size_t sweeps,
+                              bool restrLocSearch, double maxGrDist,
+                              const GeoPensMap* geoPens,
+                              const CorridorMap* corridors) {
+  if (nds.empty()) return 0;
+
+  size_t numReps = ggs.size();
+
+  // temperatures range from the average cost of a comb edge down to a
+  // hundredth of it and are lowered further after every sweep, so that all
+  // replicas have cooled down by another factor of 100 in the last sweep
+  size_t numEdgs = 0;
+  for (auto nd : nds) numEdgs += nd->getDeg();
+  numEdgs = std::max<size_t>(1, numEdgs / 2);
+  double avgCost =
+      (drawing->score() - drawing->violations() * SOFT_INF) / numEdgs;
+  if (!(avgCost > 0)) avgCost = 1;
+
+  std::vector<double> temps(numReps, avgCost);
+  for (size_t i = 1; i < numReps; i++) {
+    temps[i] = avgCost * std::pow(0.01, static_cast<double>(i) / (numReps - 1));
+  }
+  double cooling = std::pow(0.01, 1.0 / sweeps);
+
+  // replica r currently runs at temperature temps[temp[r]]
+  std::vector<size_t> temp(numReps);
+  std::vector<Drawing> reps(numReps, *drawing);
+  std::vector<std::mt19937> rngs;
+
+  for (size_t r = 0; r < numReps; r++) {
+    temp[r] = r;
+    reps[r].setBaseGraph(ggs[r]);
+    rngs.emplace_back(r);
+  }
+
+  Drawing best = *drawing;
+  std::uniform_real_distribution<double> uni(0, 1);
+  std::mt19937 rng(numReps);
+
+  size_t sweep = 0;
+  for (; sweep < sweeps; sweep++) {
+    if (cancelled() || timedOut()) break;
+    T_START(sweep);
+
+    parallelFor(numReps, [&](size_t r) {
+      auto gg = ggs[r];
+      auto& d = reps[r];
+      auto& rrng = rngs[r];
+      std::uniform_real_distribution<double> runi(0, 1);
+      double t = temps[temp[r]];
+
+      auto order = nds;
+      std::shuffle(order.begin(), order.end(), rrng);
+
+      for (auto a : order) {
+        if (cancelled() || timedOut()) break;
+
+        const GridNode* cur = d.getGrNd(a);
+        // like the local search, position maxDeg() keeps a in place and only
+        // reroutes its edges
+        auto n = gg->neigh(cur, rrng() % (gg->maxDeg() + 1));
+        if (!n) continue;
+
+        if (restrLocSearch) {
+          double gridD = dist(*a->pl().getGeom(), *n->pl().getGeom());
+          if (gridD >= gg->getCellSize() * maxGrDist) continue;
+        }
+
+        // Metropolis criterion, the move is accepted if the new score is
+        // below the limit, which therefore also bounds the routing
+        double limit = d.score() - t * std::log(1 - runi(rrng));
+
+        d.begin();
+
+        // rip up a and its edges, then reroute them from n
+        std::vector<CombEdge*> test;
+        for (auto ce : a->getAdjList()) {
+          test.push_back(ce);
+          d.eraseFromGrid(ce, gg);
+          d.erase(ce);
+        }
+
+        d.erase(a);
+        gg->unSettleNd(a);
+
+        SettledPos p;
+        p[a] = n;
+
+        auto error = draw(test, p, gg, &d, limit, maxGrDist, geoPens,
+                          corridors, std::numeric_limits<size_t>::max(), 0);
+
+        if (!error && d.score() < limit) {
+          d.commit();
+          continue;
+        }
+
+        // reject, restore the old position
+        for (auto ce : a->getAdjList()) d.eraseFromGrid(ce, gg);
+        if (gg->isSettled(a)) gg->unSettleNd(a);
+
+        d.rollback();
+
+        gg->settleNd(const_cast<GridNode*>(gg->getGrNdById(cur->pl().getId())),
+                     a);
+        for (auto ce : a->getAdjList()) d.applyToGrid(ce, gg);
+      }
+    });
+
+    for (const auto& d : reps) {
+      if (d.score() < best.score()) best = d;
+    }
+
+    // exchange the temperatures of replicas at neighboring temperatures,
+    // alternating between even and odd pairs
+    std::vector<size_t> atTemp(numReps);
+    for (size_t r = 0; r < numReps; r++) atTemp[temp[r]] = r;
+
+    for (size_t i = sweep % 2; i + 1 < numReps; i += 2) {
+      size_t a = atTemp[i], b = atTemp[i + 1];
+      double delta = (1 / temps[i] - 1 / temps[i + 1]) *
+                     (reps[a].score() - reps[b].score());
+      if (delta >= 0 || uni(rng) < std::exp(delta)) {
+        std::swap(temp[a], temp[b]);
+        std::swap(atTemp[i], atTemp[i + 1]);
+      }
+    }
+
+    for (auto& t : temps) t *= cooling;
+
+    LOGTO(DEBUG, std::cerr) << " ++ Sweep " << sweep << ", best "
+                            << best.score() << " (" << T_STOP(sweep) << " ms)";
+  }
+
+  for (size_t r = 0; r < numReps; r++) {
+    reps[r].eraseFromGrid(ggs[r]);
+    best.applyToGrid(ggs[r]);
+  }
+
+  *drawing = best;
+  drawing->setBaseGraph(ggs[0]);
+
+  return sweep;
+}
+
+// _____________________________________________________________________________
+bool Octilinearizer::nearChange(CombNode* nd, const Prior& prior) {
+  auto changed = [&prior](CombNode* n) {
+    if (!prior.nds.count(n)) return true;
+    for (auto ce : n->getAdjList()) {
+      if (!prior.edgs.count(ce)) return true;
+    }
+    return false;
+  };
+
+  if (changed(nd)) return true;
+  for (auto ce : nd->getAdjList()) {
+    if (changed(ce->getOtherNd(nd))) return true;
+  }
+  return false;
+}
+
+// _____________________________________________________________________________
+void Octilinearizer::perturb(std::vector<CombEdge*>* order, std::mt19937* rng) {
+  if (order->size() < 2) return;
+
+  // swap about every 8th edge with one of its next 3 successors, so that the
+  // ordering keeps its overall structure
+  size_t swaps = std::max<size_t>(1, order->size() / 8);
+  for (size_t i = 0; i < swaps; i++) {
+    size_t a = (*rng)() % (order->size() - 1);
+    size_t b = std::min(order->size() - 1, a + 1 + (*rng)() % 3);
+    std::swap((*order)[a], (*order)[b]);
+  }
+}
+
 // _____________________________________________________________________________
 void Octilinearizer::settleRes(GridNode* frGrNd, GridNode* toGrNd,
                                BaseGraph* gg, CombNode* from, CombNode* to,
@@ -384,13 +801,48 @@ void Octilinearizer::writeNdCosts(GridNode* n, CombNode* origNode, CombEdge* e,
 }
 
 // _____________________________________________________________________________
-Undrawable Octilinearizer::draw(const std::vector<CombEdge*>& order,
-                                BaseGraph* gg, Drawing* drawing, double cutoff,
-                                double maxGrDist, const GeoPensMap* geoPensMap,
-                                size_t abortAfter) {
-  SettledPos emptyPos;
-  return draw(order, emptyPos, gg, drawing, cutoff, maxGrDist, geoPensMap,
-              abortAfter);
+template <typename C>
+void Octilinearizer::route(BaseGraph* gg, const GridNdSet& from,
+                           const GridNdSet& to, const C& cost,
+                           const Corridor* corr, GrEdgList* eL,
+                           GrNdList* nL) const {
+  // the graph type is fixed by newBaseGraph(), so the heuristic can be
+  // dispatched statically and inlined into the relaxation loop
+  switch (_baseGraphType) {
+    case OCTIGRID:
+      return routeOn<OctiGridGraph>(gg, from, to, cost, corr, eL, nL);
+    case CONVEXHULLOCTIGRID:
+      return routeOn<ConvexHullOctiGridGraph>(gg, from, to, cost, corr, eL,
+                                              nL);
+    case GRID:
+      return routeOn<GridGraph>(gg, from, to, cost, corr, eL, nL);
+    case PSEUDOORTHORADIAL:
+      return routeOn<PseudoOrthoRadialGraph>(gg, from, to, cost, corr, eL, nL);
+    case OCTIHANANGRID:
+      return routeOn<OctiHananGraph>(gg, from, to, cost, corr, eL, nL);
+    case OCTIQUADTREE:
+      return routeOn<OctiQuadTree>(gg, from, to, cost, corr, eL, nL);
+    case OCTICORRIDORGRID:
+      return routeOn<OctiCorridorGraph>(gg, from, to, cost, corr, eL, nL);
+    default:
+      // no heuristic for the remaining types, nothing to gain
+      return routeOn<BaseGraph>(gg, from, to, cost, corr, eL, nL);
+  }
+}
+
+// _____________________________________________________________________________
+template <typename G, typename C>
+void Octilinearizer::routeOn(BaseGraph* gg, const GridNdSet& from,
+                             const GridNdSet& to, const C& cost,
+                             const Corridor* corr, GrEdgList* eL,
+                             GrNdList* nL) {
+  auto& router = gg->getRouter();
+  const G& g = static_cast<const G&>(*gg);
+  if (corr) {
+    router.route(g, from, to, CorridorCost<C>(cost, corr), cost.inf(), eL, nL);
+  } else {
+    router.route(g, from, to, cost, cost.inf(), eL, nL);
+  }
 }
 
 // _____________________________________________________________________________
@@ -398,12 +850,25 @@ Undrawable Octilinearizer::draw(const std::vector<CombEdge*>& ord,
                                 const SettledPos& settled, BaseGraph* gg,
                                 Drawing* drawing, double globCutoff,
                                 double maxGrDist, const GeoPensMap* geoPensMap,
-                                size_t abortAfter) {
+                                const CorridorMap* corridors,
+                                size_t abortAfter,
+                                const std::atomic<double>* bound) {
   SettledPos retPos;
 
   size_t i = 0;
 
   for (auto cmbEdg : ord) {
+    if (cancelled()) return CANCELLED;
+
+    // another job may have found a better drawing in the meantime
+    if (bound) globCutoff = std::min(globCutoff, bound->load());
+
+    // a finite cutoff means there already is a drawing we can fall back to
+    if (globCutoff != INF && timedOut()) return CANCELLED;
+
+    // the remaining edges only add to the score, this drawing cannot win
+    if (globCutoff != INF && drawing->score() > globCutoff) return NO_PATH;
+
     double cutoff = globCutoff - drawing->score();
     i++;
     if (drawing->score() == std::numeric_limits<double>::infinity()) {
@@ -413,7 +878,7 @@ Undrawable Octilinearizer::draw(const std::vector<CombEdge*>& ord,
     auto frCmbNd = cmbEdg->getFrom();
     auto toCmbNd = cmbEdg->getTo();
 
-    std::set<GridNode*> frGrNds, toGrNds;
+    GridNdSet frGrNds, toGrNds;
 
     std::tie(frGrNds, toGrNds) =
         getRtPair(frCmbNd, toCmbNd, settled, gg, maxGrDist);
@@ -421,12 +886,8 @@ Undrawable Octilinearizer::draw(const std::vector<CombEdge*>& ord,
     if (frGrNds.size() == 0 || toGrNds.size() == 0) return NO_CANDS;
 
     if (toGrNds.size() > frGrNds.size()) {
-      auto tmp = frCmbNd;
-      frCmbNd = toCmbNd;
-      toCmbNd = tmp;
-      auto tmp2 = frGrNds;
-      frGrNds = toGrNds;
-      toGrNds = tmp2;
+      std::swap(frCmbNd, toCmbNd);
+      std::swap(frGrNds, toGrNds);
       rev = true;
     }
 
@@ -469,11 +930,11 @@ Undrawable Octilinearizer::draw(const std::vector<CombEdge*>& ord,
     // not work if the to node is not already settled!
 
     if (frGrNds.size() == 1 && gg->isSettled(frCmbNd)) {
-      writeNdCosts(*frGrNds.begin(), frCmbNd, cmbEdg, gg);
+      writeNdCosts(frGrNds.front(), frCmbNd, cmbEdg, gg);
     }
 
     if (toGrNds.size() == 1 && gg->isSettled(toCmbNd)) {
-      writeNdCosts(*toGrNds.begin(), toCmbNd, cmbEdg, gg);
+      writeNdCosts(toGrNds.front(), toCmbNd, cmbEdg, gg);
     }
 
     GrEdgList eL;
@@ -481,20 +942,22 @@ Undrawable Octilinearizer::draw(const std::vector<CombEdge*>& ord,
     GridNode* toGrNd = 0;
     GridNode* frGrNd = 0;
 
-    auto heur = gg->getHeur(toGrNds);
+    const Corridor* corr = 0;
+    if (corridors) {
+      auto it = corridors->find(cmbEdg);
+      if (it != corridors->end()) corr = &it->second;
+    }
 
     if (geoPensMap) {
       // init cost function with geo distance penalties
-      auto cost = GridCostGeoPen(cutoff + costOffsetTo + costOffsetFrom,
+      auto cost = GridCostGeoPen(gg, cutoff + costOffsetTo + costOffsetFrom,
                                  &geoPensMap->find(cmbEdg)->second);
-      Dijkstra::shortestPath(frGrNds, toGrNds, cost, *heur, &eL, &nL);
+      route(gg, frGrNds, toGrNds, cost, corr, &eL, &nL);
     } else {
-      auto cost = GridCost(cutoff + costOffsetTo + costOffsetFrom);
-      Dijkstra::shortestPath(frGrNds, toGrNds, cost, *heur, &eL, &nL);
+      auto cost = GridCost(gg, cutoff + costOffsetTo + costOffsetFrom);
+      route(gg, frGrNds, toGrNds, cost, corr, &eL, &nL);
     }
 
-    delete heur;
-
     if (!nL.size()) {
       // cleanup
       for (auto n : toGrNds) gg->closeSinkTo(n);
@@ -507,8 +970,8 @@ Undrawable Octilinearizer::draw(const std::vector<CombEdge*>& ord,
     frGrNd = nL.back();
 
     // remove the cost offsets to not distort final costs
-    eL.front()->pl().setCost(eL.front()->pl().cost() - costOffsetTo);
-    eL.back()->pl().setCost(eL.back()->pl().cost() - costOffsetFrom);
+    gg->state(eL.front()).setCost(gg->state(eL.front()).cost() - costOffsetTo);
+    gg->state(eL.back()).setCost(gg->state(eL.back()).cost() - costOffsetFrom);
 
     // draw
     drawing->draw(cmbEdg, eL, rev);
@@ -572,7 +1035,8 @@ RtPair Octilinearizer::getRtPair(CombNode* frCmbNd, CombNode* toCmbNd,
             getCands(toCmbNd, preSettled, gg, 0)};
   }
 
-  std::set<GridNode*> frGrNds, toGrNds;
+  GridNdSet frGrNds, toGrNds;
+  std::less<GridNode*> lt;
 
   size_t i = 0;
 
@@ -580,22 +1044,27 @@ RtPair Octilinearizer::getRtPair(CombNode* frCmbNd, CombNode* toCmbNd,
     auto frCands = getCands(frCmbNd, preSettled, gg, maxGrDist);
     auto toCands = getCands(toCmbNd, preSettled, gg, maxGrDist);
 
-    std::set<GridNode*> isect;
-    std::set_intersection(frCands.begin(), frCands.end(), toCands.begin(),
-                          toCands.end(), std::inserter(isect, isect.begin()));
-
-    std::set_difference(frCands.begin(), frCands.end(), isect.begin(),
-                        isect.end(), std::inserter(frGrNds, frGrNds.begin()));
-    std::set_difference(toCands.begin(), toCands.end(), isect.begin(),
-                        isect.end(), std::inserter(toGrNds, toGrNds.begin()));
-
-    // this effectively builds a Voronoi diagram
-    for (auto iNd : isect) {
-      if (util::geo::dist(*iNd->pl().getGeom(), *frCmbNd->pl().getGeom()) <
-          util::geo::dist(*iNd->pl().getGeom(), *toCmbNd->pl().getGeom())) {
-        frGrNds.insert(iNd);
+    frGrNds.clear();
+    toGrNds.clear();
+
+    // merge the sorted candidates, nodes which are candidates for both go to
+    // the nearer one. This effectively builds a Voronoi diagram
+    auto a = frCands.begin();
+    auto b = toCands.begin();
+    while (a != frCands.end() || b != toCands.end()) {
+      if (b == toCands.end() || (a != frCands.end() && lt(*a, *b))) {
+        frGrNds.push_back(*a++);
+      } else if (a == frCands.end() || lt(*b, *a)) {
+        toGrNds.push_back(*b++);
       } else {
-        toGrNds.insert(iNd);
+        if (util::geo::dist(*(*a)->pl().getGeom(), *frCmbNd->pl().getGeom()) <
+            util::geo::dist(*(*a)->pl().getGeom(), *toCmbNd->pl().getGeom())) {
+          frGrNds.push_back(*a);
+        } else {
+          toGrNds.push_back(*a);
+        }
+        a++;
+        b++;
       }
     }
 
@@ -607,18 +1076,18 @@ RtPair Octilinearizer::getRtPair(CombNode* frCmbNd, CombNode* toCmbNd,
 }
 
 // _____________________________________________________________________________
-std::set<GridNode*> Octilinearizer::getCands(CombNode* cmbNd,
-                                             const SettledPos& preSettled,
-                                             BaseGraph* gg, size_t maxGrDist) {
-  std::set<GridNode*> ret;
+GridNdSet Octilinearizer::getCands(CombNode* cmbNd,
+                                   const SettledPos& preSettled, BaseGraph* gg,
+                                   size_t maxGrDist) {
+  GridNdSet ret;
 
   const auto& settled = gg->getSettled(cmbNd);
 
   if (settled) {
-    ret.insert(settled);
+    ret.push_back(settled);
   } else if (preSettled.count(cmbNd)) {
     auto nd = preSettled.find(cmbNd)->second->pl().getParent();
-    if (nd && !nd->pl().isClosed()) ret.insert(nd);
+    if (nd && !gg->state(nd).isClosed()) ret.push_back(nd);
   } else {
     ret = gg->getGrNdCands(cmbNd, maxGrDist);
   }
@@ -649,6 +1118,9 @@ BaseGraph* Octilinearizer::newBaseGraph(const DBox& bbox, const CombGraph& cg,
       return new OctiQuadTree(bbox, cg, cellSize, spacer, pens);
     case HEXGRID:
       return new HexGridGraph(bbox, cellSize, spacer, pens);
+    case OCTICORRIDORGRID:
+      return new OctiCorridorGraph(bbox, cg, cellSize, spacer, _corridorCells,
+                                   pens);
     default:
       return 0;
   }
@@ -682,9 +1154,38 @@ void Octilinearizer::statLine(Undrawable status, const std::string& msg,
                               << " <no cands>"
                               << " (" << ms << " ms)" << mark;
       break;
+    case CANCELLED:
+      LOGTO(DEBUG, std::cerr) << " ++ " << msg << ", score <inf>"
+                              << " <cancelled>"
+                              << " (" << ms << " ms)" << mark;
+      break;
   }
 }
 
+// _____________________________________________________________________________
+void Octilinearizer::writeGeoPens(const BaseGraph* gg,
+                                  const std::vector<CombEdge*>& edges,
+                                  double pen, size_t jobs,
+                                  GeoPensMap* target) const {
+  // the map itself must not be modified concurrently, create the entries
+  // first
+  std::vector<GeoPens*> pens;
+  for (auto ce : edges) pens.push_back(&(*target)[ce]);
+
+  parallelFor(jobs, [&](size_t btch) {
+    for (size_t i = btch; i < edges.size(); i += jobs) {
+      gg->writeGeoCoursePens(edges[i], pens[i], pen);
+    }
+  });
+}
+
+// _____________________________________________________________________________
+void Octilinearizer::setTimeLimit(double timeLimit) {
+  _hasDeadline = timeLimit >= 0;
+  _deadline = std::chrono::steady_clock::now() +
+              std::chrono::microseconds(static_cast<int64_t>(timeLimit * 1000));
+}
+
 // _____________________________________________________________________________
 size_t Octilinearizer::maxNodeDeg() const {
   // TODO: this is currently at two locations, in the base graph class and here,
@@ -706,6 +1207,8 @@ size_t Octilinearizer::maxNodeDeg() const {
       return 8;
     case HEXGRID:
       return 6;
+    case OCTICORRIDORGRID:
+      return 8;
     default:
       return 8;
   }
@@ -5,12 +5,19 @@
 #ifndef OCTI_OCTILINEARIZER_H_
 #define OCTI_OCTILINEARIZER_H_
 
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <random>
+#include <thread>
 #include <unordered_set>
 #include <vector>
 
 #include "ilp/ILPGridOptimizer.h"
 #include "octi/basegraph/BaseGraph.h"
+#include "octi/basegraph/GridCsr.h"
 #include "octi/basegraph/GridGraph.h"
+#include "octi/basegraph/GridRouter.h"
 #include "octi/combgraph/CombGraph.h"
 #include "octi/combgraph/Drawing.h"
 #include "octi/config/OctiConfig.h"
@@ -20,11 +27,14 @@
 
 namespace octi {
 
+using octi::basegraph::Corridor;
+using octi::basegraph::CorridorMap;
 using octi::basegraph::GeoPens;
 using octi::basegraph::GeoPensMap;
 using octi::basegraph::GridEdge;
 using octi::basegraph::GridEdgePL;
 using octi::basegraph::GridGraph;
+using octi::basegraph::GridNdSet;
 using octi::basegraph::GridNode;
 using octi::basegraph::GridNodePL;
 using octi::basegraph::NodeCost;
@@ -46,10 +56,26 @@ using util::graph::Dijkstra;
 
 typedef util::graph::EList<GridNodePL, GridEdgePL> GrEdgList;
 typedef util::graph::NList<GridNodePL, GridEdgePL> GrNdList;
-typedef std::pair<std::set<GridNode*>, std::set<GridNode*>> RtPair;
+typedef std::pair<GridNdSet, GridNdSet> RtPair;
 typedef std::map<CombNode*, const GridNode*> SettledPos;
 
-enum Undrawable { DRAWN = 0, NO_PATH = 1, NO_CANDS = 2 };
+// positions and paths from an earlier drawing of the same comb graph, either
+// on a coarser grid or of an earlier version of the input
+struct Prior {
+  // start positions of the nodes
+  std::map<CombNode*, util::geo::DPoint> nds;
+
+  // edges with a path are only routed within corridorRad around it, edges
+  // without one are routed freely
+  std::map<const CombEdge*, util::geo::DLine> edgs;
+  double corridorRad = 0;
+
+  // if set, only a single ordering is tried, edges with a path first, and
+  // local search only moves nodes near edges without a path
+  bool local = false;
+};
+
+enum Undrawable { DRAWN = 0, NO_PATH = 1, NO_CANDS = 2, CANCELLED = 3 };
 
 // exception thrown when no planar embedding could be found
 struct NoEmbeddingFoundExc : public std::exception {
@@ -132,14 +158,18 @@ struct GraphMeasures {
 
 struct GridCost
     : public util::graph::Dijkstra::CostFunc<GridNodePL, GridEdgePL, float> {
-  GridCost(float inf) : _inf(inf) {}
+  GridCost(const basegraph::BaseGraph* g, float inf) : _g(g), _inf(inf) {}
   virtual float operator()(const GridNode* from, const GridEdge* e,
                            const GridNode* to) const {
     UNUSED(from);
     UNUSED(to);
-    return e->pl().cost();
+    return _g->state(e).cost();
   }
 
+  // cost by edge id, for routing on the CSR view
+  float operator()(uint32_t e) const { return _g->edgState(e).cost(); }
+
+  const basegraph::BaseGraph* _g;
   float _inf;
 
   virtual float inf() const { return _inf; }
@@ -147,33 +177,79 @@ struct GridCost
 
 struct GridCostGeoPen
     : public Dijkstra::CostFunc<GridNodePL, GridEdgePL, float> {
-  GridCostGeoPen(float inf, const GeoPens* geoPens)
-      : _inf(inf), _geoPens(geoPens) {}
+  GridCostGeoPen(const basegraph::BaseGraph* g, float inf,
+                 const GeoPens* geoPens)
+      : _g(g), _inf(inf), _geoPens(geoPens) {}
   virtual float operator()(const GridNode* from, const GridEdge* e,
                            const GridNode* to) const {
     UNUSED(from);
     UNUSED(to);
 
     // ignore geopens for secondary edges
-    if (e->pl().isSecondary()) return e->pl().cost();
-
-    auto i = (*_geoPens).find(e->pl().getId());
-    if (i != _geoPens->end()) return e->pl().cost() + i->second;
+    if (e->pl().isSecondary()) return _g->state(e).cost();
 
     // if no geopen was present for grid edge, we assume SOFT_INF penalty
-    return e->pl().cost() + octi::basegraph::SOFT_INF;
+    return _g->state(e).cost() +
+           _geoPens->get(e->pl().getId(), octi::basegraph::SOFT_INF);
   }
 
+  // cost by edge id, for routing on the CSR view
+  float operator()(uint32_t e) const {
+    if (_g->getCsr().isSecondary(e)) return _g->edgState(e).cost();
+
+    return _g->edgState(e).cost() +
+           _geoPens->get(e, octi::basegraph::SOFT_INF);
+  }
+
+  const basegraph::BaseGraph* _g;
   float _inf;
   const GeoPens* _geoPens;
 
   virtual float inf() const { return _inf; }
 };
 
+// restricts a cost function to the grid edges of a corridor
+template <typename C>
+struct CorridorCost {
+  CorridorCost(const C& cost, const Corridor* corr)
+      : _cost(cost), _corr(corr) {}
+
+  float operator()(uint32_t e) const {
+    if (!_corr->has(e)) return _cost.inf();
+    return _cost(e);
+  }
+
+  const C& _cost;
+  const Corridor* _corr;
+
+  float inf() const { return _cost.inf(); }
+};
+
 class Octilinearizer {
  public:
-  Octilinearizer(basegraph::BaseGraphType baseGraphType)
-      : _baseGraphType(baseGraphType) {}
+  Octilinearizer(basegraph::BaseGraphType baseGraphType, size_t corridorCells)
+      : _baseGraphType(baseGraphType),
+        _corridorCells(corridorCells),
+        _cancel(0),
+        _hasDeadline(false),
+        _landmarks(0),
+        _tempering(false) {}
+
+  // if the flag is set during draw(), the drawing is aborted as soon as
+  // possible. The result of an aborted drawing is undefined.
+  void setCancelFlag(const std::atomic<bool>* cancel) { _cancel = cancel; }
+
+  // after timeLimit ms from now, draw() stops searching and returns the best
+  // drawing found so far. The search is never stopped before a first
+  // drawing has been found. A negative limit means no limit.
+  void setTimeLimit(double timeLimit);
+
+  // route with an additional ALT heuristic over num landmarks, 0 for none
+  void setLandmarks(size_t num) { _landmarks = num; }
+
+  // optimize with parallel tempering instead of a greedy local search, one
+  // replica per thread
+  void setTempering(bool tempering) { _tempering = tempering; }
 
   Score draw(const CombGraph& cg, const util::geo::DBox& box, LineGraph* out,
              basegraph::BaseGraph** gg, Drawing* d, const Penalties& pens,
@@ -181,7 +257,32 @@ class Octilinearizer {
              config::OrderMethod orderMethod, bool restrLocSearch,
              double enfGeoCourse, size_t hananIters,
              const std::vector<util::geo::Polygon<double>>& obstacles,
-             size_t locsearchIters, size_t abortAfter);
+             size_t locsearchIters, size_t abortAfter, size_t numThreads);
+
+  // draw on a grid coarsened by coarseFactor first, then re-route every edge
+  // on the full grid within a corridor around its coarse path
+  Score drawMultilevel(
+      const CombGraph& cg, const util::geo::DBox& box, LineGraph* out,
+      basegraph::BaseGraph** gg, Drawing* d, const Penalties& pens,
+      double gridSize, double borderRad, double maxGrDist,
+      config::OrderMethod orderMethod, bool restrLocSearch,
+      double enfGeoCourse, size_t hananIters,
+      const std::vector<util::geo::Polygon<double>>& obstacles,
+      size_t locsearchIters, size_t abortAfter, size_t numThreads,
+      size_t coarseFactor);
+
+  // redraw starting from seed, the drawing of an earlier version of the
+  // input. Unchanged nodes and edges are kept close to their positions in
+  // the seed, only changed edges are routed freely.
+  Score drawSeeded(
+      const CombGraph& cg, const util::geo::DBox& box, LineGraph* out,
+      basegraph::BaseGraph** gg, Drawing* d, const Penalties& pens,
+      double gridSize, double borderRad, double maxGrDist,
+      config::OrderMethod orderMethod, bool restrLocSearch,
+      double enfGeoCourse, size_t hananIters,
+      const std::vector<util::geo::Polygon<double>>& obstacles,
+      size_t locsearchIters, size_t abortAfter, size_t numThreads,
+      const LineGraph& seed);
 
   Score drawILP(const CombGraph& cg, const util::geo::DBox& box, LineGraph* out,
                 basegraph::BaseGraph** gg, Drawing* d, const Penalties& pens,
@@ -196,6 +297,17 @@ class Octilinearizer {
 
  private:
   basegraph::BaseGraphType _baseGraphType;
+  size_t _corridorCells;
+  const std::atomic<bool>* _cancel;
+  bool _hasDeadline;
+  std::chrono::steady_clock::time_point _deadline;
+  size_t _landmarks;
+  bool _tempering;
+
+  bool cancelled() const { return _cancel && *_cancel; }
+  bool timedOut() const {
+    return _hasDeadline && std::chrono::steady_clock::now() >= _deadline;
+  }
 
   basegraph::BaseGraph* newBaseGraph(const util::geo::DBox& bbox,
                                      const CombGraph& cg, double cellSize,
@@ -213,16 +325,60 @@ class Octilinearizer {
 
   static const CombNode* getCenterNd(const CombGraph* cg);
 
+  // parallel tempering over the positions of nds, with one replica on each
+  // of ggs, starting from drawing. Writes the best drawing found to drawing
+  // and all of ggs, returns the number of sweeps done.
+  size_t temper(const std::vector<CombNode*>& nds,
+                const std::vector<basegraph::BaseGraph*>& ggs,
+                Drawing* drawing, size_t sweeps, bool restrLocSearch,
+                double maxGrDist, const GeoPensMap* geoPens,
+                const CorridorMap* corridors);
+
+  // true if nd or one of its neighbors lacks a prior position or is adjacent
+  // to an edge without a prior path
+  static bool nearChange(CombNode* nd, const Prior& prior);
+
+  // a few random swaps of nearby edges in order
+  static void perturb(std::vector<CombEdge*>* order, std::mt19937* rng);
+
   std::vector<CombEdge*> getOrdering(const CombGraph& cg,
                                      octi::config::OrderMethod method) const;
 
-  Undrawable draw(const std::vector<CombEdge*>& order, basegraph::BaseGraph* gg,
-                  Drawing* drawing, double cutoff, double maxGrDist,
-                  const GeoPensMap* geoPensMap, size_t abortAfter);
+  // geo course pens of all edges, computed on jobs threads
+  void writeGeoPens(const basegraph::BaseGraph* gg,
+                    const std::vector<CombEdge*>& edges, double pen,
+                    size_t jobs, GeoPensMap* target) const;
+
+  // if prior is given, nodes start at their prior positions and edges are
+  // only routed within a corridor around their prior paths
+  Score draw(const CombGraph& cg, const util::geo::DBox& box, LineGraph* out,
+             basegraph::BaseGraph** gg, Drawing* d, const Penalties& pens,
+             double gridSize, double borderRad, double maxGrDist,
+             config::OrderMethod orderMethod, bool restrLocSearch,
+             double enfGeoCourse, size_t hananIters,
+             const std::vector<util::geo::Polygon<double>>& obstacles,
+             size_t locsearchIters, size_t abortAfter, size_t numThreads,
+             const Prior* prior);
+
+  // if bound is given, it is read before every edge and lowers the cutoff,
+  // the drawing is given up once its partial score reaches it
   Undrawable draw(const std::vector<CombEdge*>& order,
                   const SettledPos& settled, basegraph::BaseGraph* gg,
                   Drawing* drawing, double cutoff, double maxGrDist,
-                  const GeoPensMap* geoPensMap, size_t abortAfter);
+                  const GeoPensMap* geoPensMap, const CorridorMap* corridors,
+                  size_t abortAfter, const std::atomic<double>* bound);
+
+  // routes with the kernel for the concrete type of the graphs created by
+  // newBaseGraph()
+  template <typename C>
+  void route(basegraph::BaseGraph* gg, const GridNdSet& from,
+             const GridNdSet& to, const C& cost, const Corridor* corr,
+             GrEdgList* eL, GrNdList* nL) const;
+
+  template <typename G, typename C>
+  static void routeOn(basegraph::BaseGraph* gg, const GridNdSet& from,
+                      const GridNdSet& to, const C& cost, const Corridor* corr,
+                      GrEdgList* eL, GrNdList* nL);
 
   SettledPos neigh(const SettledPos& pos, const std::vector<CombNode*>&,
                    size_t i) const;
@@ -231,13 +387,40 @@ class Octilinearizer {
                    const SettledPos& settled, basegraph::BaseGraph* gg,
                    double maxGrDist);
 
-  std::set<GridNode*> getCands(CombNode* cmBnd, const SettledPos& settled,
-                               basegraph::BaseGraph* gg, size_t maxGridDis);
+  GridNdSet getCands(CombNode* cmBnd, const SettledPos& settled,
+                     basegraph::BaseGraph* gg, size_t maxGridDis);
 
   void statLine(Undrawable status, const std::string& msg,
                 const Drawing& drawing, double ms,
                 const std::string& mark) const;
 
+  // run f(0), ..., f(jobs - 1) on jobs threads and wait for all of them, the
+  // first exception thrown by a job is rethrown afterwards
+  template <typename F>
+  static void parallelFor(size_t jobs, F f) {
+    if (jobs == 1) {
+      f(0);
+      return;
+    }
+
+    std::vector<std::exception_ptr> excs(jobs);
+    std::vector<std::thread> thrds;
+    for (size_t i = 0; i < jobs; i++) {
+      thrds.emplace_back([&, i]() {
+        try {
+          f(i);
+        } catch (...) {
+          excs[i] = std::current_exception();
+        }
+      });
+    }
+    for (auto& thr : thrds) thr.join();
+
+    for (const auto& exc : excs) {
+      if (exc) std::rethrow_exception(exc);
+    }
+  }
+
   template <class ECmp, class NCmp>
   std::vector<CombEdge*> getGrowthOrder(const CombGraph& cg) const {
     ECmp eCmp;
@@ -0,0 +1,138 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+#include "octi/Seed.h"
+
+using octi::Seed;
+using octi::combgraph::CombEdge;
+using octi::combgraph::CombGraph;
+using octi::combgraph::CombNode;
+using shared::linegraph::LineEdge;
+using shared::linegraph::LineGraph;
+using shared::linegraph::LineNode;
+using util::geo::DLine;
+using util::geo::DPoint;
+
+namespace {
+// _____________________________________________________________________________
+bool hasStation(const LineNode* n) {
+  return n->pl().stops().size() && n->pl().stops().front().id.size();
+}
+
+// _____________________________________________________________________________
+std::string lineKey(const LineEdge* e) {
+  std::vector<std::string> ids;
+  for (const auto& lo : e->pl().getLines()) ids.push_back(lo.line->id());
+  std::sort(ids.begin(), ids.end());
+
+  std::string ret;
+  for (const auto& id : ids) ret += id + ",";
+  return ret;
+}
+
+// follows e from n over degree 2 nodes until a node for which stop() is true,
+// returns that node. The geometry of the passed edges is appended to geom,
+// the line keys of the passed edges are written to lines.
+template <typename F>
+LineNode* follow(LineNode* n, LineEdge* e, F stop, DLine* geom,
+                 std::set<std::string>* lines) {
+  LineNode* cur = n;
+  while (true) {
+    if (lines) lines->insert(lineKey(e));
+
+    if (geom) {
+      const auto& l = e->pl().getPolyline().getLine();
+      if (e->getFrom() == cur) {
+        geom->insert(geom->end(), l.begin(), l.end());
+      } else {
+        geom->insert(geom->end(), l.rbegin(), l.rend());
+      }
+    }
+
+    LineNode* next = e->getOtherNd(cur);
+    if (next == n || stop(next) || next->getDeg() != 2) return next;
+
+    LineEdge* nextE = next->getAdjList().front();
+    if (nextE == e) nextE = next->getAdjList().back();
+    if (nextE == e) return next;
+
+    cur = next;
+    e = nextE;
+  }
+}
+
+// _____________________________________________________________________________
+std::string nodeKey(LineNode* n) {
+  if (hasStation(n)) return "s:" + n->pl().stops().front().id;
+
+  // a node without a station is identified by its arms, each given by its
+  // lines and the station it leads to
+  std::vector<std::string> arms;
+  for (auto e : n->getAdjList()) {
+    auto end = follow(n, e, hasStation, 0, 0);
+    std::string endId = hasStation(end) ? end->pl().stops().front().id : "";
+    arms.push_back(lineKey(e) + "@" + endId);
+  }
+  std::sort(arms.begin(), arms.end());
+
+  std::string ret = "j:";
+  for (const auto& arm : arms) ret += arm + "|";
+  return ret;
+}
+}  // namespace
+
+// _____________________________________________________________________________
+Seed::Seed(const CombGraph& cg, const LineGraph& seed) {
+  std::map<std::string, std::vector<LineNode*>> seedNds;
+  for (auto n : seed.getNds()) seedNds[nodeKey(n)].push_back(n);
+
+  std::map<std::string, std::vector<CombNode*>> cgNds;
+  for (auto cn : cg.getNds()) {
+    if (cn->getDeg() == 0) continue;
+    cgNds[nodeKey(cn->pl().getParent())].push_back(cn);
+  }
+
+  // seed node of each matched comb node, and vice versa
+  std::map<const CombNode*, LineNode*> m;
+  std::set<const LineNode*> images;
+
+  for (const auto& k : cgNds) {
+    if (k.second.size() != 1) continue;
+    auto it = seedNds.find(k.first);
+    if (it == seedNds.end() || it->second.size() != 1) continue;
+
+    _nds[k.second.front()] = *it->second.front()->pl().getGeom();
+    m[k.second.front()] = it->second.front();
+    images.insert(it->second.front());
+  }
+
+  auto isImage = [&images](const LineNode* n) { return images.count(n); };
+
+  for (auto cn : cg.getNds()) {
+    for (auto ce : cn->getAdjList()) {
+      if (ce->getFrom() != cn) continue;
+
+      auto fr = m.find(ce->getFrom());
+      auto to = m.find(ce->getTo());
+      if (fr == m.end() || to == m.end()) continue;
+
+      std::set<std::string> lines;
+      for (auto e : ce->pl().getChilds()) lines.insert(lineKey(e));
+
+      for (auto e : fr->second->getAdjList()) {
+        DLine geom;
+        std::set<std::string> seedLines;
+        auto end = follow(fr->second, e, isImage, &geom, &seedLines);
+
+        if (end == to->second && seedLines == lines) {
+          _edgs[ce] = geom;
+          break;
+        }
+      }
+    }
+  }
+}
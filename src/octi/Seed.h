@@ -0,0 +1,47 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef OCTI_SEED_H_
+#define OCTI_SEED_H_
+
+#include <map>
+#include <string>
+#include "octi/combgraph/CombGraph.h"
+#include "shared/linegraph/LineGraph.h"
+#include "util/geo/Geo.h"
+
+namespace octi {
+
+/*
+ * Matches a comb graph against the octilinear drawing of an earlier version
+ * of its input. Nodes are identified by their station id, nodes without a
+ * station by their adjacent lines and the stations they lead to. Ambiguous
+ * nodes are not matched. A comb edge is unchanged if both of its nodes were
+ * matched and the drawing connects them with the same lines.
+ */
+class Seed {
+ public:
+  Seed(const octi::combgraph::CombGraph& cg,
+       const shared::linegraph::LineGraph& seed);
+
+  // positions of the matched nodes in the seed drawing
+  const std::map<octi::combgraph::CombNode*, util::geo::DPoint>& getNds()
+      const {
+    return _nds;
+  }
+
+  // paths of the unchanged edges in the seed drawing
+  const std::map<const octi::combgraph::CombEdge*, util::geo::DLine>&
+  getEdgs() const {
+    return _edgs;
+  }
+
+ private:
+  std::map<octi::combgraph::CombNode*, util::geo::DPoint> _nds;
+  std::map<const octi::combgraph::CombEdge*, util::geo::DLine> _edgs;
+};
+
+}  // namespace octi
+
+#endif  // OCTI_SEED_H_
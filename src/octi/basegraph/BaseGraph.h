@@ -4,11 +4,15 @@
 #ifndef OCTI_BASEGRAPH_BASEGRAPH_H_
 #define OCTI_BASEGRAPH_BASEGRAPH_H_
 
+#include <algorithm>
+#include <memory>
 #include <queue>
 #include <set>
 #include <unordered_map>
+#include <vector>
 #include "octi/basegraph/GridEdgePL.h"
 #include "octi/basegraph/GridNodePL.h"
+#include "octi/basegraph/GridState.h"
 #include "octi/basegraph/NodeCost.h"
 #include "octi/combgraph/CombGraph.h"
 #include "util/geo/Geo.h"
@@ -28,10 +32,6 @@ using octi::combgraph::CombNode;
 namespace octi {
 namespace basegraph {
 
-const static double INF = std::numeric_limits<double>::infinity();
-
-const static double SOFT_INF = 100000;
-
 enum BaseGraphType {
   HEXGRID,
   OCTIGRID,
@@ -40,19 +40,86 @@ enum BaseGraphType {
   ORTHORADIAL,
   PSEUDOORTHORADIAL,
   OCTIHANANGRID,
-  OCTIQUADTREE
+  OCTIQUADTREE,
+  OCTICORRIDORGRID
 };
 
+class GridCsr;
+class GridRouter;
+class Landmarks;
+
 typedef util::graph::Node<GridNodePL, GridEdgePL> GridNode;
 typedef util::graph::Edge<GridNodePL, GridEdgePL> GridEdge;
 
 typedef std::pair<const GridEdge*, const GridEdge*> EdgPair;
 typedef std::vector<std::pair<EdgPair, EdgPair>> CrossEdgPairs;
 
-// edge-id -> pen
-typedef std::unordered_map<uint32_t, float> GeoPens;
+// edge-id -> pen, as a vector sorted by the edge id
+class GeoPens {
+ public:
+  // entries may be added in any order, sort() must be called before the
+  // first lookup
+  void add(uint32_t e, float pen) { _pens.push_back({e, pen}); }
+  void sort() { std::sort(_pens.begin(), _pens.end()); }
+
+  // the pen of edge e, or def if there is none
+  float get(uint32_t e, float def) const {
+    auto it = std::lower_bound(
+        _pens.begin(), _pens.end(), e,
+        [](const std::pair<uint32_t, float>& a, uint32_t b) {
+          return a.first < b;
+        });
+    if (it != _pens.end() && it->first == e) return it->second;
+    return def;
+  }
+
+  size_t size() const { return _pens.size(); }
+
+ private:
+  std::vector<std::pair<uint32_t, float>> _pens;
+};
+
 typedef std::map<const CombEdge*, GeoPens> GeoPensMap;
 
+// ids of the grid edges a comb edge may be routed over, as a bitset over
+// the id range they span, so that the router tests an edge with one index
+class Corridor {
+ public:
+  void add(const std::vector<uint32_t>& edgs) {
+    if (edgs.empty()) return;
+    uint32_t first = *std::min_element(edgs.begin(), edgs.end());
+    uint32_t last = *std::max_element(edgs.begin(), edgs.end());
+
+    if (!_edgs.empty()) {
+      first = std::min<uint32_t>(first, _first);
+      last = std::max<uint32_t>(last, _first + _edgs.size() - 1);
+    }
+
+    std::vector<bool> edgsNew(last - first + 1, false);
+    for (size_t i = 0; i < _edgs.size(); i++) {
+      edgsNew[_first - first + i] = _edgs[i];
+    }
+    for (auto e : edgs) edgsNew[e - first] = true;
+
+    _first = first;
+    _edgs.swap(edgsNew);
+  }
+
+  // ids below _first wrap around and are out of range as well
+  bool has(uint32_t e) const {
+    return e - _first < _edgs.size() && _edgs[e - _first];
+  }
+
+ private:
+  uint32_t _first = 0;
+  std::vector<bool> _edgs;
+};
+
+typedef std::map<const CombEdge*, Corridor> CorridorMap;
+
+// grid nodes as a vector, sorted by address like a std::set<GridNode*>
+typedef std::vector<GridNode*> GridNdSet;
+
 struct Candidate {
   Candidate(GridNode* n, double d) : n(n), d(d){};
 
@@ -76,9 +143,44 @@ struct Penalties {
 
 class BaseGraph : public DirGraph<GridNodePL, GridEdgePL> {
  public:
-  BaseGraph(){};
+  BaseGraph() : _topo(this){};
+  virtual ~BaseGraph(){};
+
+  BaseGraph& operator=(const BaseGraph&) = delete;
 
   virtual void init() = 0;
+
+  // a new graph sharing the nodes and edges of this graph, with its own copy
+  // of the current node and edge states. The graph which was init()'ed must
+  // outlive all graphs forked from it.
+  virtual BaseGraph* fork() const = 0;
+
+  // all grid nodes, also for forked graphs
+  const std::set<GridNode*>& getGrNds() const { return _topo->getNds(); }
+
+  GridEdgeState& state(const GridEdge* e) {
+    return _edgStates[e->pl().getId()];
+  }
+  const GridEdgeState& state(const GridEdge* e) const {
+    return _edgStates[e->pl().getId()];
+  }
+  GridNodeState& state(const GridNode* n) { return _ndStates[n->pl().getId()]; }
+  const GridNodeState& state(const GridNode* n) const {
+    return _ndStates[n->pl().getId()];
+  }
+  const GridEdgeState& edgState(uint32_t id) const { return _edgStates[id]; }
+
+  // index-based view of the topology, used for routing
+  const GridCsr& getCsr() const { return *_csr; }
+
+  // the routing engine of this graph, created on first use
+  GridRouter& getRouter();
+
+  // landmark distance tables for the A* heuristic, computed from the current
+  // edge costs and shared with all graphs forked afterwards. 0 if not built.
+  void initLandmarks(size_t num);
+  const Landmarks* getLandmarks() const { return _lms.get(); }
+
   virtual double getCellSize() const = 0;
 
   virtual NodeCost nodeBendPen(GridNode* n, CombNode* origNode,
@@ -93,6 +195,10 @@ class BaseGraph : public DirGraph<GridNodePL, GridEdgePL> {
   virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
   getHeur(const std::set<GridNode*>& to) const = 0;
 
+  // true if routing should use heurCost() towards the target hull as A*
+  // heuristic
+  virtual bool useHullHeur() const = 0;
+
   virtual std::priority_queue<Candidate> getGridNdCands(
       const util::geo::DPoint& p, size_t maxGrD) const = 0;
 
@@ -109,7 +215,7 @@ class BaseGraph : public DirGraph<GridNodePL, GridEdgePL> {
 
   virtual size_t maxDeg() const = 0;
 
-  virtual std::set<GridNode*> getGrNdCands(CombNode* n, size_t maxDis) = 0;
+  virtual GridNdSet getGrNdCands(CombNode* n, size_t maxDis) = 0;
 
   virtual void settleNd(GridNode* n, CombNode* cn) = 0;
   virtual void settleEdg(GridNode* a, GridNode* b, CombEdge* e) = 0;
@@ -138,14 +244,40 @@ class BaseGraph : public DirGraph<GridNodePL, GridEdgePL> {
   virtual std::set<CombEdge*> getResEdgs(const GridEdge* ge) const = 0;
   virtual std::set<CombEdge*> getResEdgsDirInd(const GridEdge* ge) const = 0;
 
-  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPensMap* target,
-                                  double pen) = 0;
+  // must be safe to call concurrently for different comb edges
+  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPens* target,
+                                  double pen) const = 0;
+
+  virtual void writeCorridor(const CombEdge* ce, const util::geo::DLine& path,
+                             double maxD, CorridorMap* target) const = 0;
 
   virtual CrossEdgPairs getCrossEdgPairs() const = 0;
 
-  virtual void addObstacle(const util::geo::Polygon<double>& obst) = 0;
+  virtual void addObstacles(const std::vector<util::geo::DPolygon>& obsts) = 0;
   virtual PolyLine<double> geomFromPath(
       const std::vector<std::pair<size_t, size_t>>& res) const = 0;
+
+ protected:
+  // forks share the topology, but never copy the nodes and edges
+  BaseGraph(const BaseGraph& g)
+      : DirGraph<GridNodePL, GridEdgePL>(),
+        _topo(g._topo),
+        _csr(g._csr),
+        _lms(g._lms),
+        _edgStates(g._edgStates),
+        _ndStates(g._ndStates){};
+
+  // the graph owning the nodes and edges
+  const BaseGraph* _topo;
+  std::shared_ptr<const GridCsr> _csr;
+  std::shared_ptr<const Landmarks> _lms;
+
+  // never shared, every graph routes with its own engine
+  std::shared_ptr<GridRouter> _router;
+
+  // per-graph state, indexed by edge and node ids
+  std::vector<GridEdgeState> _edgStates;
+  std::vector<GridNodeState> _ndStates;
 };
 }  // namespace basegraph
 }  // namespace octi
@@ -21,19 +21,19 @@ using util::geo::DPoint;
 
 // _____________________________________________________________________________
 void ConvexHullOctiGridGraph::init() {
-  _ndIdx.resize(_grid.getXWidth() * _grid.getYHeight());
+  _ndIdx.resize(_grid->getXWidth() * _grid->getYHeight());
 
   // write nodes
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
       if (skip(x, y)) continue;
       writeNd(x, y);
     }
   }
 
   // write grid edges
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
       GridNode* center = getNode(x, y);
       if (!center) continue;
 
@@ -50,8 +50,15 @@ void ConvexHullOctiGridGraph::init() {
     }
   }
 
+  initState();
   writeInitialCosts();
   prunePorts();
+  initCsr();
+}
+
+// _____________________________________________________________________________
+BaseGraph* ConvexHullOctiGridGraph::fork() const {
+  return new ConvexHullOctiGridGraph(*this);
 }
 
 // _____________________________________________________________________________
@@ -63,8 +70,8 @@ bool ConvexHullOctiGridGraph::skip(size_t x, size_t y) const {
 
 // _____________________________________________________________________________
 GridNode* ConvexHullOctiGridGraph::getNode(size_t x, size_t y) const {
-  if (x >= _grid.getXWidth() || y >= _grid.getYHeight()) return 0;
-  auto a = _ndIdx[x * _grid.getYHeight() + y];
+  if (x >= _grid->getXWidth() || y >= _grid->getYHeight()) return 0;
+  auto a = _ndIdx[x * _grid->getYHeight() + y];
   if (a == 0) return 0;
   return _nds[a - 1];
 }
@@ -77,9 +84,9 @@ GridNode* ConvexHullOctiGridGraph::writeNd(size_t x, size_t y) {
   GridNode* n = addNd(DPoint(xPos, yPos));
   n->pl().setId(_nds.size());
   _nds.push_back(n);
-  _ndIdx[x * _grid.getYHeight() + y] = _nds.size();
+  _ndIdx[x * _grid->getYHeight() + y] = _nds.size();
   n->pl().setSink();
-  _grid.add(x, y, n);
+  _grid->add(x, y, n);
   n->pl().setXY(x, y);
   n->pl().setParent(n);
 
@@ -111,8 +118,9 @@ GridNode* ConvexHullOctiGridGraph::writeNd(size_t x, size_t y) {
 
       if (x == 0 && (i == 5 || i == 6 || i == 7)) pen = INF;
       if (y == 0 && (i == 0 || i == 7 || i == 1)) pen = INF;
-      if (x == _grid.getXWidth() - 1 && (i == 1 || i == 2 || i == 3)) pen = INF;
-      if (y == _grid.getYHeight() - 1 && (i == 3 || i == 4 || i == 5))
+      if (x == _grid->getXWidth() - 1 && (i == 1 || i == 2 || i == 3))
+        pen = INF;
+      if (y == _grid->getYHeight() - 1 && (i == 3 || i == 4 || i == 5))
         pen = INF;
 
       auto e = addEdg(n->pl().getPort(i), n->pl().getPort(j),
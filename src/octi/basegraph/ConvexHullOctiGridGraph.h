@@ -20,6 +20,7 @@ class ConvexHullOctiGridGraph : public OctiGridGraph {
       : OctiGridGraph(bbox, cellSize, spacer, pens), _hull(hull) {
   }
   virtual void init();
+  virtual BaseGraph* fork() const;
 
  protected:
   virtual bool skip(size_t x, size_t y) const;
@@ -0,0 +1,63 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <algorithm>
+#include "octi/basegraph/GridCsr.h"
+
+using octi::basegraph::BaseGraph;
+using octi::basegraph::GridCsr;
+
+const uint32_t GridCsr::NONE;
+
+// _____________________________________________________________________________
+GridCsr::GridCsr(const BaseGraph& g) {
+  size_t numNds = 0;
+  size_t numEdgs = 0;
+
+  for (auto n : g.getGrNds()) {
+    numNds = std::max(numNds, n->pl().getId() + 1);
+    for (auto e : n->getAdjListOut()) {
+      numEdgs = std::max(numEdgs, e->pl().getId() + 1);
+    }
+  }
+
+  _nds.resize(numNds, 0);
+  _x.resize(numNds, 0);
+  _y.resize(numNds, 0);
+  _parents.resize(numNds, NONE);
+  _portEdgs.resize(numNds, NONE);
+  _offs.resize(numNds + 1, 0);
+
+  _edgs.resize(numEdgs, 0);
+  _secondary.resize(numEdgs, false);
+
+  for (auto n : g.getGrNds()) {
+    size_t id = n->pl().getId();
+    _nds[id] = n;
+    _x[id] = n->pl().getParent()->pl().getX();
+    _y[id] = n->pl().getParent()->pl().getY();
+    _parents[id] = n->pl().getParent()->pl().getId();
+    _offs[id + 1] = n->getAdjListOut().size();
+  }
+
+  for (size_t i = 0; i < numNds; i++) _offs[i + 1] += _offs[i];
+
+  _tgts.resize(_offs.back());
+  _arcEdgs.resize(_offs.back());
+
+  for (auto n : g.getGrNds()) {
+    size_t a = _offs[n->pl().getId()];
+    size_t numPrim = 0;
+    for (auto e : n->getAdjListOut()) {
+      _tgts[a] = e->getTo()->pl().getId();
+      _arcEdgs[a] = e->pl().getId();
+      _edgs[e->pl().getId()] = e;
+      _secondary[e->pl().getId()] = e->pl().isSecondary();
+      a++;
+
+      if (e->pl().isSecondary()) continue;
+      _portEdgs[n->pl().getId()] = ++numPrim == 1 ? e->pl().getId() : NONE;
+    }
+  }
+}
@@ -0,0 +1,68 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef OCTI_BASEGRAPH_GRIDCSR_H_
+#define OCTI_BASEGRAPH_GRIDCSR_H_
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "octi/basegraph/BaseGraph.h"
+
+namespace octi {
+namespace basegraph {
+
+/*
+ * Compressed sparse row representation of the (immutable) topology of a grid
+ * graph. Nodes and edges are addressed by their 32 bit ids, the outgoing arcs
+ * of node i are stored at [_offs[i], _offs[i + 1]). Nodes carry only the grid
+ * coordinates of their cell, the geometry is implicit. The mutable edge costs
+ * are not part of this, they are read from the GridEdgeState vector of the
+ * graph which does the routing (see GridRouter).
+ */
+class GridCsr {
+ public:
+  static const uint32_t NONE = std::numeric_limits<uint32_t>::max();
+
+  explicit GridCsr(const BaseGraph& g);
+
+  uint32_t numNds() const { return _offs.size() - 1; }
+  uint32_t numEdgs() const { return _edgs.size(); }
+
+  uint32_t arcsBegin(uint32_t nd) const { return _offs[nd]; }
+  uint32_t arcsEnd(uint32_t nd) const { return _offs[nd + 1]; }
+  uint32_t arcTo(uint32_t arc) const { return _tgts[arc]; }
+  uint32_t arcEdg(uint32_t arc) const { return _arcEdgs[arc]; }
+
+  uint32_t getX(uint32_t nd) const { return _x[nd]; }
+  uint32_t getY(uint32_t nd) const { return _y[nd]; }
+  uint32_t getParent(uint32_t nd) const { return _parents[nd]; }
+  bool isSecondary(uint32_t edg) const { return _secondary[edg]; }
+
+  // the primary edge leaving port node nd, NONE if there is none or if
+  // there are several
+  uint32_t portEdg(uint32_t nd) const { return _portEdgs[nd]; }
+
+  GridNode* getNd(uint32_t nd) const { return _nds[nd]; }
+  GridEdge* getEdg(uint32_t edg) const { return _edgs[edg]; }
+
+ private:
+  std::vector<uint32_t> _offs;
+  std::vector<uint32_t> _tgts;
+  std::vector<uint32_t> _arcEdgs;
+
+  std::vector<uint32_t> _x, _y;
+  std::vector<uint32_t> _parents;
+  std::vector<bool> _secondary;
+  std::vector<uint32_t> _portEdgs;
+
+  // pruned nodes and edges leave holes in here
+  std::vector<GridNode*> _nds;
+  std::vector<GridEdge*> _edgs;
+};
+
+}  // namespace basegraph
+}  // namespace octi
+
+#endif  // OCTI_BASEGRAPH_GRIDCSR_H_
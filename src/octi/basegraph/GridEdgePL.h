@@ -23,26 +23,11 @@ class GridEdgePL : util::geograph::GeoEdgePL<double> {
   const util::geo::Line<double>* getGeom() const;
   util::json::Dict getAttrs() const;
 
-  void setCost(double c);
-  double cost() const;
-  double rawCost() const;
+  // the cost the edge starts with, the current cost and the closed and
+  // blocked flags are kept per graph in a GridEdgeState
+  double initCost() const;
   bool isSecondary() const;
 
-  void close();
-  void softClose();
-  void open();
-  bool closed() const;
-
-  size_t resEdgs() const;
-
-  void block();
-  void unblock();
-
-  void reset();
-
-  void delResEdg();
-  void addResEdge();
-
   void setId(size_t id);
   size_t getId() const;
 
@@ -52,14 +37,6 @@ class GridEdgePL : util::geograph::GeoEdgePL<double> {
   bool _isSecondary : 1;
   bool _isSink : 1;
 
-  bool _closed : 1;
-  bool _softClosed : 1;
-
-  // edges are blocked if they would cross a settled edge
-  bool _blocked : 1;
-
-  uint8_t _resEdgs : 8;
-
   uint32_t _id;
 };
 }
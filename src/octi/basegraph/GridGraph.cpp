@@ -7,8 +7,10 @@
 #include <unordered_map>
 #include <unordered_set>
 
+#include "octi/basegraph/GridCsr.h"
 #include "octi/basegraph/GridGraph.h"
 #include "octi/basegraph/NodeCost.h"
+#include "octi/basegraph/ObstacleIdx.h"
 #include "util/Misc.h"
 #include "util/geo/BezierCurve.h"
 #include "util/geo/Point.h"
@@ -31,7 +33,8 @@ GridGraph::GridGraph(const DBox& bbox, double cellSize, double spacer,
                      const Penalties& pens)
     : _bbox(bbox),
       _c(pens),
-      _grid(cellSize, cellSize, bbox, false),
+      _grid(std::make_shared<Grid<GridNode*, Point, double>>(
+          cellSize, cellSize, bbox, false)),
       _cellSize(cellSize),
       _spacer(spacer),
       _edgeCount(0) {
@@ -51,15 +54,15 @@ GridGraph::GridGraph(const DBox& bbox, double cellSize, double spacer,
 // _____________________________________________________________________________
 void GridGraph::init() {
   // write nodes
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
       writeNd(x, y);
     }
   }
 
   // write grid edges
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
       GridNode* center = getNode(x, y);
 
       for (size_t p = 0; p < maxDeg(); p++) {
@@ -75,17 +78,38 @@ void GridGraph::init() {
     }
   }
 
+  initState();
   writeInitialCosts();
   prunePorts();
+  initCsr();
 }
 
+// _____________________________________________________________________________
+void GridGraph::initState() {
+  _ndStates.assign(_nds.size(), GridNodeState());
+  _edgStates.assign(_edgeCount, GridEdgeState());
+  _resEdgs.assign(_edgeCount, {});
+
+  for (auto n : getNds()) {
+    for (auto e : n->getAdjListOut()) {
+      _edgStates[e->pl().getId()] = GridEdgeState(e->pl().initCost());
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void GridGraph::initCsr() { _csr = std::make_shared<GridCsr>(*this); }
+
+// _____________________________________________________________________________
+BaseGraph* GridGraph::fork() const { return new GridGraph(*this); }
+
 // _____________________________________________________________________________
 size_t GridGraph::maxDeg() const { return 4; }
 
 // _____________________________________________________________________________
 GridNode* GridGraph::getNode(size_t x, size_t y) const {
-  if (x >= _grid.getXWidth() || y >= _grid.getYHeight()) return 0;
-  return _nds[_grid.getYHeight() * 5 * x + y * 5];
+  if (x >= _grid->getXWidth() || y >= _grid->getYHeight()) return 0;
+  return _nds[_grid->getYHeight() * 5 * x + y * 5];
 }
 
 // _____________________________________________________________________________
@@ -117,9 +141,10 @@ GridNode* GridGraph::neigh(const GridNode* n, size_t i) const {
 
 // _____________________________________________________________________________
 void GridGraph::unSettleNd(CombNode* a) {
-  openTurns(_settled[a]);
-  _settled[a]->pl().setSettled(false);
-  _settled.erase(a);
+  auto& n = _settled[a->pl().getId()];
+  openTurns(n);
+  state(n).setSettled(false);
+  n = 0;
 }
 
 // _____________________________________________________________________________
@@ -133,15 +158,15 @@ void GridGraph::unSettleEdg(CombEdge* ce, GridNode* a, GridNode* b) {
   assert(ge);
   assert(gf);
 
-  ge->pl().delResEdg();
-  gf->pl().delResEdg();
+  state(ge).delResEdg();
+  state(gf).delResEdg();
 
-  _resEdgs[ge].erase(ce);
-  _resEdgs[gf].erase(ce);
+  delResEdg(ge, ce);
+  delResEdg(gf, ce);
 
-  if (_resEdgs[ge].size() == 0) {
-    if (!a->pl().isSettled() && unused(a)) openTurns(a);
-    if (!b->pl().isSettled() && unused(b)) openTurns(b);
+  if (numResEdgs(ge) == 0) {
+    if (!state(a).isSettled() && unused(a)) openTurns(a);
+    if (!state(b).isSettled() && unused(b)) openTurns(b);
   }
 }
 
@@ -149,81 +174,133 @@ void GridGraph::unSettleEdg(CombEdge* ce, GridNode* a, GridNode* b) {
 CrossEdgPairs GridGraph::getCrossEdgPairs() const { return {}; }
 
 // _____________________________________________________________________________
-void GridGraph::addObstacle(const util::geo::Polygon<double>& obst) {
-  _obstacles.push_back(obst);
-  writeObstacleCost(obst);
-}
+void GridGraph::addObstacles(const std::vector<util::geo::DPolygon>& obsts) {
+  ObstacleIdx idx(obsts, _bbox);
+  if (idx.empty()) return;
 
-// _____________________________________________________________________________
-void GridGraph::writeObstacleCost(const util::geo::Polygon<double>& obst) {
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
-      auto grNdA = getNode(x, y);
+  // forks may still share the current list
+  auto blocked = std::make_shared<std::vector<uint32_t>>();
+  if (_obstEdgs) *blocked = *_obstEdgs;
 
-      for (size_t i = 0; i < maxDeg(); i++) {
-        auto grNeigh = neigh(x, y, i);
-        if (!grNeigh) continue;
-        auto ge = getNEdg(grNdA, grNeigh);
-
-        if (!ge) continue;
-
-        if (intersects(LineSegment<double>(*ge->getFrom()->pl().getGeom(),
-                                           *ge->getTo()->pl().getGeom()),
-                       obst) ||
-            contains(LineSegment<double>(*ge->getFrom()->pl().getGeom(),
-                                         *ge->getTo()->pl().getGeom()),
-                     obst)) {
-          ge->pl().setCost(std::numeric_limits<double>::infinity());
-        }
+  for (auto grNdA : getGrNds()) {
+    if (!grNdA->pl().isSink()) continue;
+
+    for (size_t i = 0; i < maxDeg(); i++) {
+      auto ge = getNEdg(grNdA, neigh(grNdA, i));
+      if (!ge) continue;
+
+      if (idx.blocks(*ge->getFrom()->pl().getGeom(),
+                     *ge->getTo()->pl().getGeom())) {
+        blocked->push_back(ge->pl().getId());
       }
     }
   }
+
+  _obstEdgs = blocked;
+  reWriteObstCosts();
 }
 
 // _____________________________________________________________________________
-void GridGraph::writeGeoCoursePens(const CombEdge* ce, GeoPensMap* target,
-                                   double pen) {
-  std::set<GridNode*> neighs;
+void GridGraph::writeGeoCoursePens(const CombEdge* ce, GeoPens* target,
+                                   double pen) const {
+  // grid edges farther away from the input geometry get a pen above SOFT_INF,
+  // which is the default for edges without a pen anyway
+  double maxD = sqrt(SOFT_INF / pen) * getCellSize();
 
-  DBox box;
+  std::set<GridNode*> neighs;
 
-  std::vector<util::geo::DLine> geoms;
+  // for each (simplified) child geometry, the distance of all ports within
+  // maxD of it. Ports are only looked up near each segment, via the node
+  // index, instead of measuring every port against every geometry
+  std::vector<std::unordered_map<const GridNode*, double>> ds;
 
   for (auto orE : ce->pl().getChilds()) {
-    box = util::geo::extendBox(*orE->pl().getGeom(), box);
+    auto geom = util::geo::simplify(*orE->pl().getGeom(), 5);
+    if (geom.empty()) continue;
 
-    // operate on simplified geometries
-    geoms.push_back(util::geo::simplify(*orE->pl().getGeom(), 5));
-  }
+    ds.emplace_back();
+    auto& d = ds.back();
 
-  box = util::geo::pad(box, sqrt(SOFT_INF / pen) * getCellSize());
-  _grid.get(box, &neighs);
+    for (size_t i = 0; i + 1 < std::max<size_t>(geom.size(), 2); i++) {
+      util::geo::DLine seg(geom.begin() + i,
+                           geom.begin() + std::min(i + 2, geom.size()));
+
+      // ports lie within a cell of their node
+      DBox box = util::geo::pad(util::geo::extendBox(seg, DBox()),
+                                maxD + getCellSize());
+      std::set<GridNode*> segNeighs;
+      _grid->get(box, &segNeighs);
+
+      for (auto grNd : segNeighs) {
+        neighs.insert(grNd);
+        for (size_t j = 0; j < maxDeg(); j++) {
+          auto port = grNd->pl().getPort(j);
+          if (!port) continue;
+
+          double dLoc = dist(seg, *port->pl().getGeom());
+          auto it = d.find(port);
+          if (it == d.end()) {
+            d[port] = dLoc;
+          } else if (dLoc < it->second) {
+            it->second = dLoc;
+          }
+        }
+      }
+    }
+  }
 
   for (auto grNdA : neighs) {
     for (size_t i = 0; i < maxDeg(); i++) {
       auto grNeigh = neigh(grNdA->pl().getX(), grNdA->pl().getY(), i);
       if (!grNeigh) continue;
       auto ge = getNEdg(grNdA, grNeigh);
+      if (!ge) continue;
 
       float d = std::numeric_limits<float>::infinity();
 
-      for (const auto& geom : geoms) {
-        double dLoc = fmax(
-            fmax(dist(geom, *ge->getFrom()->pl().getGeom()) / getCellSize(),
-                 dist(geom, util::geo::centroid(util::geo::MultiPoint<double>{
-                                *ge->getFrom()->pl().getGeom(),
-                                *ge->getFrom()->pl().getGeom()})) /
-                     getCellSize()),
-            dist(geom, *ge->getTo()->pl().getGeom()) / getCellSize());
+      for (const auto& dGeom : ds) {
+        auto fr = dGeom.find(ge->getFrom());
+        if (fr == dGeom.end()) continue;
+        auto to = dGeom.find(ge->getTo());
+        if (to == dGeom.end()) continue;
 
+        double dLoc = fmax(fr->second, to->second) / getCellSize();
         if (dLoc < d) d = dLoc;
       }
 
       d *= pen * d;
 
-      if (d <= SOFT_INF) (*target)[ce][ge->pl().getId()] = d;
+      if (d <= SOFT_INF) target->add(ge->pl().getId(), d);
+    }
+  }
+
+  target->sort();
+}
+
+// _____________________________________________________________________________
+void GridGraph::writeCorridor(const CombEdge* ce, const util::geo::DLine& path,
+                              double maxD, CorridorMap* target) const {
+  std::set<GridNode*> neighs;
+
+  DBox box = util::geo::pad(util::geo::extendBox(path, DBox()), maxD);
+  _grid->get(box, &neighs);
+
+  std::vector<uint32_t> corr;
+
+  for (auto grNd : neighs) {
+    if (dist(path, *grNd->pl().getGeom()) > maxD) continue;
+
+    // all edges leaving the node, or one of its ports, belong to the
+    // corridor. Edges into neighbors outside of it are dead ends.
+    for (auto e : grNd->getAdjListOut()) corr.push_back(e->pl().getId());
+    for (size_t i = 0; i < maxDeg(); i++) {
+      auto port = grNd->pl().getPort(i);
+      if (!port) continue;
+      for (auto e : port->getAdjListOut()) corr.push_back(e->pl().getId());
     }
   }
+
+  (*target)[ce].add(corr);
 }
 
 // _____________________________________________________________________________
@@ -253,32 +330,37 @@ bool GridGraph::unused(const GridNode* gnd) const {
     if (!neighbor) continue;
     auto e = getNEdg(gnd, neighbor);
     auto f = getNEdg(neighbor, gnd);
-    auto a = _resEdgs.find(const_cast<GridEdge*>(e));
 
-    if (a != _resEdgs.end()) {
-      assert(a->second.size() == e->pl().resEdgs());
-    }
-    if (a != _resEdgs.end() && a->second.size() != 0) return false;
-    a = _resEdgs.find(const_cast<GridEdge*>(f));
-    if (a != _resEdgs.end()) assert(a->second.size() == f->pl().resEdgs());
-    if (a != _resEdgs.end() && a->second.size() != 0) return false;
+    assert(numResEdgs(e) == state(e).resEdgs());
+    assert(numResEdgs(f) == state(f).resEdgs());
+
+    if (numResEdgs(e) || numResEdgs(f)) return false;
   }
   return true;
 }
 
 // _____________________________________________________________________________
 void GridGraph::addResEdg(GridEdge* ge, CombEdge* ce) {
-  ge->pl().addResEdge();
-  _resEdgs[ge].insert(ce);
-  assert(_resEdgs[ge].size() == ge->pl().resEdgs());
+  auto& res = _resEdgs[ge->pl().getId()];
+  auto it = std::lower_bound(res.begin(), res.end(), ce);
+
+  state(ge).addResEdge();
+  if (it == res.end() || *it != ce) res.insert(it, ce);
+  assert(res.size() == state(ge).resEdgs());
+}
+
+// _____________________________________________________________________________
+void GridGraph::delResEdg(const GridEdge* ge, CombEdge* ce) {
+  auto& res = _resEdgs[ge->pl().getId()];
+  auto it = std::lower_bound(res.begin(), res.end(), ce);
+  if (it != res.end() && *it == ce) res.erase(it);
 }
 
 // _____________________________________________________________________________
 std::set<CombEdge*> GridGraph::getResEdgs(const GridEdge* ge) const {
   if (!ge) return {};
-  if (_resEdgs.count(const_cast<GridEdge*>(ge)))
-    return _resEdgs.find(const_cast<GridEdge*>(ge))->second;
-  return {};
+  const auto& res = _resEdgs[ge->pl().getId()];
+  return std::set<CombEdge*>(res.begin(), res.end());
 }
 
 // _____________________________________________________________________________
@@ -286,17 +368,31 @@ std::set<CombEdge*> GridGraph::getResEdgsDirInd(const GridEdge* ge) const {
   std::set<CombEdge*> ret;
   if (!ge) return {};
   auto otherEdge = getEdg(ge->getTo(), ge->getFrom());
-  if (_resEdgs.count(const_cast<GridEdge*>(ge))) {
-    const auto& tmp = _resEdgs.find(const_cast<GridEdge*>(ge))->second;
-    ret.insert(tmp.begin(), tmp.end());
-  }
-  if (otherEdge && _resEdgs.count(const_cast<GridEdge*>(otherEdge))) {
-    const auto& tmp = _resEdgs.find(const_cast<GridEdge*>(otherEdge))->second;
+  const auto& tmp = _resEdgs[ge->pl().getId()];
+  ret.insert(tmp.begin(), tmp.end());
+  if (otherEdge) {
+    const auto& tmp = _resEdgs[otherEdge->pl().getId()];
     ret.insert(tmp.begin(), tmp.end());
   }
   return ret;
 }
 
+// _____________________________________________________________________________
+GridEdge* GridGraph::portEdg(const GridNode* pa, const GridNode* pb) const {
+  if (!pa || !pb) return 0;
+
+  if (_csr) {
+    uint32_t e = _csr->portEdg(pa->pl().getId());
+    if (e != GridCsr::NONE) {
+      auto ge = _csr->getEdg(e);
+      return ge->getTo() == pb ? ge : 0;
+    }
+  }
+
+  // during init(), or for ports with several primary edges
+  return const_cast<GridEdge*>(getEdg(pa, pb));
+}
+
 // _____________________________________________________________________________
 GridEdge* GridGraph::getNEdg(const GridNode* a, const GridNode* b) const {
   if (!a || !b) return 0;
@@ -318,14 +414,8 @@ GridEdge* GridGraph::getNEdg(const GridNode* a, const GridNode* b) const {
   else
     return 0;
 
-  if (a->pl().getPort(dir) &&
-      b->pl().getPort((dir + maxDeg() / 2) % maxDeg())) {
-    return const_cast<GridEdge*>(
-        getEdg(a->pl().getPort(dir),
-               b->pl().getPort((dir + maxDeg() / 2) % maxDeg())));
-  }
-
-  return 0;
+  return portEdg(a->pl().getPort(dir),
+                 b->pl().getPort((dir + maxDeg() / 2) % maxDeg()));
 }
 
 // _____________________________________________________________________________
@@ -433,8 +523,8 @@ NodeCost GridGraph::spacingPen(GridNode* nd, CombNode* origNd, CombEdge* edg) {
       if (!neighbor) {
         addSpace++;
       }
-      if (neighbor && !out[cur] && neighbor->pl().isClosed() &&
-          !neighbor->pl().isSettled()) {
+      if (neighbor && !out[cur] && state(neighbor).isClosed() &&
+          !state(neighbor).isSettled()) {
         addSpace++;
       }
       addC[cur] = -1.0 * std::numeric_limits<double>::max();
@@ -447,8 +537,8 @@ NodeCost GridGraph::spacingPen(GridNode* nd, CombNode* origNd, CombEdge* edg) {
       if (!neighbor) {
         addSpace++;
       }
-      if (neighbor && !out[cur] && neighbor->pl().isClosed() &&
-          !neighbor->pl().isSettled()) {
+      if (neighbor && !out[cur] && state(neighbor).isClosed() &&
+          !state(neighbor).isSettled()) {
         addSpace++;
       }
       addC[cur] = -1.0 * std::numeric_limits<double>::max();
@@ -495,19 +585,19 @@ void GridGraph::addCostVec(GridNode* n, const NodeCost& addC) {
     if (!p) continue;
 
     if (addC[i] < -1) {
-      getEdg(p, n)->pl().softClose();
-      getEdg(n, p)->pl().softClose();
+      state(getEdg(p, n)).softClose();
+      state(getEdg(n, p)).softClose();
     } else {
-      getEdg(p, n)->pl().setCost(getEdg(p, n)->pl().rawCost() + addC[i]);
-      getEdg(n, p)->pl().setCost(getEdg(n, p)->pl().rawCost() + addC[i]);
+      state(getEdg(p, n)).setCost(state(getEdg(p, n)).rawCost() + addC[i]);
+      state(getEdg(n, p)).setCost(state(getEdg(n, p)).rawCost() + addC[i]);
     }
   }
 }
 
 // _____________________________________________________________________________
 void GridGraph::writeInitialCosts() {
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
       auto n = getNode(x, y);
       for (size_t i = 0; i < maxDeg(); i++) {
         auto port = n->pl().getPort(i);
@@ -519,9 +609,9 @@ void GridGraph::writeInitialCosts() {
         auto e = getEdg(port, oPort);
 
         if (i % 2 == 0) {
-          e->pl().setCost(_c.verticalPen);
+          state(e).setCost(_c.verticalPen);
         } else {
-          e->pl().setCost(_c.horizontalPen);
+          state(e).setCost(_c.horizontalPen);
         }
       }
     }
@@ -539,10 +629,10 @@ std::priority_queue<Candidate> GridGraph::getGridNdCands(const DPoint& p,
   DBox b(DPoint(p.getX() - maxD, p.getY() - maxD),
          DPoint(p.getX() + maxD, p.getY() + maxD));
 
-  _grid.get(b, &neigh);
+  _grid->get(b, &neigh);
 
   for (auto n : neigh) {
-    if (n->pl().isClosed() || n->pl().isSettled()) continue;
+    if (state(n).isClosed() || state(n).isSettled()) continue;
     double d = dist(*n->pl().getGeom(), p);
 
     if (d < maxD) ret.push(Candidate(n, d));
@@ -553,32 +643,7 @@ std::priority_queue<Candidate> GridGraph::getGridNdCands(const DPoint& p,
 
 // _____________________________________________________________________________
 const Grid<GridNode*, Point, double>& GridGraph::getGrid() const {
-  return _grid;
-}
-
-// _____________________________________________________________________________
-double GridGraph::heurCost(int64_t xa, int64_t ya, int64_t xb,
-                           int64_t yb) const {
-  int dx = labs(xb - xa);
-  int dy = labs(yb - ya);
-
-  // Alternative: use chebyshev distance heuristic
-  // double minHops = std::max(dx, dy);
-
-  // double heurECost =
-  // (std::min(_c.verticalPen, std::min(_c.horizontalPen, _c.diagonalPen)));
-
-  // return minHops * (heurECost + _heurHopCost) - _heurHopCost;
-
-  double edgCost = ((_c.horizontalPen + _heurHopCost) * dx +
-                    (_c.verticalPen + _heurHopCost) * dy);
-
-  // we have to do at least one turn, which can only be a 90 degree turn
-  if (dx != 0 && dy != 0) edgCost += _c.p_90;
-
-  // we always count one heurHopCost too much, subtract it at the end, but
-  // dont make negative!
-  return fmax(0, edgCost - _heurHopCost);
+  return *_grid;
 }
 
 // _____________________________________________________________________________
@@ -587,9 +652,12 @@ GridGraph::getHeur(const std::set<GridNode*>& to) const {
   return new GridGraphHeur(this, to);
 }
 
+// _____________________________________________________________________________
+bool GridGraph::useHullHeur() const { return true; }
+
 // _____________________________________________________________________________
 void GridGraph::openTurns(GridNode* n) {
-  if (!n->pl().isClosed()) return;
+  if (!state(n).isClosed()) return;
 
   // open all non-sink inner edges
   for (size_t i = 0; i < maxDeg(); i++) {
@@ -601,17 +669,17 @@ void GridGraph::openTurns(GridNode* n) {
       auto e = getEdg(portA, portB);
       auto f = getEdg(portB, portA);
 
-      e->pl().open();
-      f->pl().open();
+      state(e).open();
+      state(f).open();
     }
   }
 
-  n->pl().setClosed(false);
+  state(n).setClosed(false);
 }
 
 // _____________________________________________________________________________
 void GridGraph::closeTurns(GridNode* n) {
-  if (n->pl().isClosed()) return;
+  if (state(n).isClosed()) return;
 
   // close all non-sink inner edges
   for (size_t i = 0; i < maxDeg(); i++) {
@@ -623,20 +691,20 @@ void GridGraph::closeTurns(GridNode* n) {
       auto e = getEdg(portA, portB);
       auto f = getEdg(portB, portA);
 
-      e->pl().softClose();
-      f->pl().softClose();
+      state(e).softClose();
+      state(f).softClose();
     }
   }
 
-  n->pl().setClosed(true);
+  state(n).setClosed(true);
 }
 
 // _____________________________________________________________________________
 void GridGraph::openSinkTo(GridNode* n, double cost) {
   for (size_t i = 0; i < maxDeg(); i++) {
     if (!n->pl().getPort(i)) continue;
-    getEdg(n->pl().getPort(i), n)->pl().open();
-    getEdg(n->pl().getPort(i), n)->pl().setCost(cost);
+    state(getEdg(n->pl().getPort(i), n)).open();
+    state(getEdg(n->pl().getPort(i), n)).setCost(cost);
   }
 }
 
@@ -644,8 +712,8 @@ void GridGraph::openSinkTo(GridNode* n, double cost) {
 void GridGraph::closeSinkTo(GridNode* n) {
   for (size_t i = 0; i < maxDeg(); i++) {
     if (!n->pl().getPort(i)) continue;
-    getEdg(n->pl().getPort(i), n)->pl().close();
-    getEdg(n->pl().getPort(i), n)->pl().setCost(INF);
+    state(getEdg(n->pl().getPort(i), n)).close();
+    state(getEdg(n->pl().getPort(i), n)).setCost(INF);
   }
 }
 
@@ -653,8 +721,8 @@ void GridGraph::closeSinkTo(GridNode* n) {
 void GridGraph::openSinkFr(GridNode* n, double cost) {
   for (size_t i = 0; i < maxDeg(); i++) {
     if (!n->pl().getPort(i)) continue;
-    getEdg(n, n->pl().getPort(i))->pl().open();
-    getEdg(n, n->pl().getPort(i))->pl().setCost(cost);
+    state(getEdg(n, n->pl().getPort(i))).open();
+    state(getEdg(n, n->pl().getPort(i))).setCost(cost);
   }
 }
 
@@ -662,27 +730,26 @@ void GridGraph::openSinkFr(GridNode* n, double cost) {
 void GridGraph::closeSinkFr(GridNode* n) {
   for (size_t i = 0; i < maxDeg(); i++) {
     if (!n->pl().getPort(i)) continue;
-    getEdg(n, n->pl().getPort(i))->pl().close();
-    getEdg(n, n->pl().getPort(i))->pl().setCost(INF);
+    state(getEdg(n, n->pl().getPort(i))).close();
+    state(getEdg(n, n->pl().getPort(i))).setCost(INF);
   }
 }
 
 // _____________________________________________________________________________
 GridNode* GridGraph::getSettled(const CombNode* cnd) const {
-  auto i = _settled.find(cnd);
-  if (i != _settled.end()) return i->second;
+  if (cnd->pl().getId() < _settled.size()) return _settled[cnd->pl().getId()];
   return 0;
 }
 
 // _____________________________________________________________________________
-std::set<GridNode*> GridGraph::getGrNdCands(CombNode* n, size_t maxDis) {
-  std::set<GridNode*> tos;
+GridNdSet GridGraph::getGrNdCands(CombNode* n, size_t maxDis) {
+  GridNdSet tos;
   if (!isSettled(n)) {
-    auto cands = getGridNdCands(*n->pl().getGeom(), maxDis);
+    for (auto cand : nearNds(n, maxDis)) {
+      if (state(cand).isClosed() || state(cand).isSettled()) continue;
 
-    while (!cands.empty()) {
-      size_t x = cands.top().n->pl().getParent()->pl().getX();
-      size_t y = cands.top().n->pl().getParent()->pl().getY();
+      size_t x = cand->pl().getParent()->pl().getX();
+      size_t y = cand->pl().getParent()->pl().getY();
 
       // getGrNdDeg returns the maximum node degree of the grid node at this
       // position to prevent choosing nodes which cannot hold the CombNode
@@ -690,26 +757,53 @@ std::set<GridNode*> GridGraph::getGrNdCands(CombNode* n, size_t maxDis) {
       // If such nodes are chosen, the greedy heuristic algorithm will fall into
       // a local optimum which is a death valley - there is now way out
 
-      if (!cands.top().n->pl().isClosed() && getGrNdDeg(n, x, y) >= n->getDeg())
-        tos.insert(cands.top().n);
-      cands.pop();
+      if (getGrNdDeg(n, x, y) >= n->getDeg()) tos.push_back(cand);
     }
   } else {
-    tos.insert(_settled.find(n)->second);
+    tos.push_back(getSettled(n));
   }
 
   return tos;
 }
 
+// _____________________________________________________________________________
+const GridNdSet& GridGraph::nearNds(const CombNode* n, size_t maxDis) {
+  size_t id = n->pl().getId();
+  if (id >= _nearNds.size()) _nearNds.resize(id + 1);
+
+  auto it = _nearNds[id].find(maxDis);
+  if (it != _nearNds[id].end()) return it->second;
+
+  auto& near = _nearNds[id][maxDis];
+
+  const auto& p = *n->pl().getGeom();
+  double maxD = getCellSize() * maxDis;
+
+  DBox b(DPoint(p.getX() - maxD, p.getY() - maxD),
+         DPoint(p.getX() + maxD, p.getY() + maxD));
+
+  // the set already is in address order
+  std::set<GridNode*> neigh;
+  _grid->get(b, &neigh);
+
+  for (auto nd : neigh) {
+    if (dist(*nd->pl().getGeom(), p) < maxD) near.push_back(nd);
+  }
+
+  return near;
+}
+
 // _____________________________________________________________________________
 void GridGraph::settleNd(GridNode* n, CombNode* cn) {
-  _settled[cn] = n;
-  n->pl().setSettled(true);
+  if (cn->pl().getId() >= _settled.size())
+    _settled.resize(cn->pl().getId() + 1, 0);
+  _settled[cn->pl().getId()] = n;
+  state(n).setSettled(true);
 }
 
 // _____________________________________________________________________________
 bool GridGraph::isSettled(const CombNode* cn) {
-  return _settled.find(cn) != _settled.end();
+  return getSettled(cn) != 0;
 }
 
 // _____________________________________________________________________________
@@ -731,7 +825,7 @@ GridNode* GridGraph::writeNd(size_t x, size_t y) {
   n->pl().setId(_nds.size());
   _nds.push_back(n);
   n->pl().setSink();
-  _grid.add(x, y, n);
+  _grid->add(x, y, n);
   n->pl().setXY(x, y);
   n->pl().setParent(n);
 
@@ -774,8 +868,8 @@ GridNode* GridGraph::writeNd(size_t x, size_t y) {
 
       if (x == 0 && i == 3) pen = INF;
       if (y == 0 && i == 0) pen = INF;
-      if (x == _grid.getXWidth() - 1 && i == 1) pen = INF;
-      if (y == _grid.getYHeight() - 1 && i == 2) pen = INF;
+      if (x == _grid->getXWidth() - 1 && i == 1) pen = INF;
+      if (y == _grid->getYHeight() - 1 && i == 2) pen = INF;
 
       auto e = addEdg(n->pl().getPort(i), n->pl().getPort(j),
                       GridEdgePL(pen, true, false));
@@ -818,9 +912,9 @@ double GridGraph::ndMovePen(const CombNode* cbNd, const GridNode* grNd) const {
 // _____________________________________________________________________________
 void GridGraph::reset() {
   _settled.clear();
-  _resEdgs.clear();
-  for (auto n : getNds()) {
-    for (auto e : n->getAdjListOut()) e->pl().reset();
+  for (auto& res : _resEdgs) res.clear();
+  for (auto n : getGrNds()) {
+    for (auto e : n->getAdjListOut()) state(e).reset();
     if (!n->pl().isSink()) continue;
     openTurns(n);
     closeSinkFr(n);
@@ -833,7 +927,8 @@ void GridGraph::reset() {
 
 // _____________________________________________________________________________
 void GridGraph::reWriteObstCosts() {
-  for (const auto& obst : _obstacles) writeObstacleCost(obst);
+  if (!_obstEdgs) return;
+  for (auto id : *_obstEdgs) _edgStates[id].setCost(INF);
 }
 
 // _____________________________________________________________________________
@@ -884,7 +979,10 @@ size_t GridGraph::getGrNdDeg(const CombNode* nd, size_t x, size_t y) const {
   size_t closed = 0;
   size_t notPresent = 0;
 
-  std::set<const GridNode*> settledNeighs;
+  // at most maxDeg() <= 8 entries, no need for a set
+  const GridNode* settledNeighs[8];
+  size_t numSettled = 0;
+
   for (size_t i = 0; i < maxDeg(); i++) {
     auto n = neigh(x, y, i);
     if (!n) {
@@ -892,22 +990,29 @@ size_t GridGraph::getGrNdDeg(const CombNode* nd, size_t x, size_t y) const {
       continue;
     }
 
-    if (n->pl().isSettled()) {
-      settledNeighs.insert(n);
-    } else if (n->pl().isClosed()) {
+    if (state(n).isSettled()) {
+      if (std::find(settledNeighs, settledNeighs + numSettled, n) ==
+          settledNeighs + numSettled) {
+        settledNeighs[numSettled++] = n;
+      }
+    } else if (state(n).isClosed()) {
       closed++;
     }
   }
 
   // subtract the settled nodes which are grid nodes for adjacent comb nodes
   for (auto e : nd->getAdjList()) {
-    auto ond = e->getOtherNd(nd);
-    settledNeighs.erase(getSettled(ond));
+    auto ond = getSettled(e->getOtherNd(nd));
+    for (size_t i = 0; i < numSettled; i++) {
+      if (settledNeighs[i] != ond) continue;
+      settledNeighs[i] = settledNeighs[--numSettled];
+      break;
+    }
   }
 
   UNUSED(x);
 
-  return maxDeg() - settledNeighs.size() - closed - notPresent;
+  return maxDeg() - numSettled - closed - notPresent;
 }
 
 // _____________________________________________________________________________
@@ -5,6 +5,10 @@
 #ifndef OCTI_BASEGRAPH_GRIDGRAPH_H_
 #define OCTI_BASEGRAPH_GRIDGRAPH_H_
 
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <memory>
 #include <queue>
 #include <set>
 #include <unordered_map>
@@ -58,7 +62,7 @@ class GridGraph : public BaseGraph {
   virtual GridNode* neigh(const GridNode* n, size_t i) const;
   virtual size_t maxDeg() const;
 
-  virtual std::set<GridNode*> getGrNdCands(CombNode* n, size_t maxGrDist);
+  virtual GridNdSet getGrNdCands(CombNode* n, size_t maxGrDist);
 
   virtual void settleNd(GridNode* n, CombNode* cn);
   virtual void settleEdg(GridNode* a, GridNode* b, CombEdge* e);
@@ -73,6 +77,7 @@ class GridGraph : public BaseGraph {
 
   virtual GridEdge* getNEdg(const GridNode* a, const GridNode* b) const;
   virtual void init();
+  virtual BaseGraph* fork() const;
   virtual void reset();
 
   virtual GridNode* getSettled(const CombNode* cnd) const;
@@ -87,13 +92,17 @@ class GridGraph : public BaseGraph {
 
   virtual CrossEdgPairs getCrossEdgPairs() const;
 
-  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPensMap* target,
-                                  double pen);
+  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPens* target,
+                                  double pen) const;
 
-  virtual void addObstacle(const util::geo::Polygon<double>& obst);
+  virtual void writeCorridor(const CombEdge* ce, const util::geo::DLine& path,
+                             double maxD, CorridorMap* target) const;
+
+  virtual void addObstacles(const std::vector<util::geo::DPolygon>& obsts);
 
   virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
   getHeur(const std::set<GridNode*>& to) const;
+  virtual bool useHullHeur() const;
 
   virtual PolyLine<double> geomFromPath(
       const std::vector<std::pair<size_t, size_t>>& res) const;
@@ -101,12 +110,19 @@ class GridGraph : public BaseGraph {
   virtual void prunePorts();
 
  protected:
+  // the grid edge from port pa to port pb, 0 if there is none. Once the
+  // topology is complete this is a table lookup.
+  GridEdge* portEdg(const GridNode* pa, const GridNode* pb) const;
+
   util::geo::DBox _bbox;
   Penalties _c;
 
-  Grid<GridNode*, Point, double> _grid;
+  // the spatial grid index is part of the topology and shared between forks
+  std::shared_ptr<Grid<GridNode*, Point, double>> _grid;
   double _cellSize, _spacer;
-  std::unordered_map<const CombNode*, GridNode*> _settled;
+
+  // settled grid node per comb node id, 0 if not settled
+  std::vector<GridNode*> _settled;
 
   double _heurHopCost;
 
@@ -116,15 +132,32 @@ class GridGraph : public BaseGraph {
   // edge id counter
   size_t _edgeCount;
 
-  std::vector<util::geo::Polygon<double>> _obstacles;
+  // ids of the grid edges blocked by obstacles, shared between forks
+  std::shared_ptr<const std::vector<uint32_t>> _obstEdgs;
+
+  // resident comb edges per grid edge id, kept sorted. May be multiple if
+  // hard constraints are relaxed, but almost always 0 or 1
+  std::vector<std::vector<CombEdge*>> _resEdgs;
 
-  // may be multiple resident edges if hard constraints are relaxed
-  std::unordered_map<GridEdge*, std::set<CombEdge*>> _resEdgs;
+  // grid nodes within some radius around a comb node, by comb node id and
+  // radius. The candidate search widens the radius step by step, so a node
+  // usually has a few of them. This only depends on the topology, the state
+  // is checked on every lookup
+  std::vector<std::map<size_t, GridNdSet>> _nearNds;
+
+  const GridNdSet& nearNds(const CombNode* n, size_t maxDis);
+
+  void delResEdg(const GridEdge* ge, CombEdge* ce);
+  size_t numResEdgs(const GridEdge* ge) const {
+    return _resEdgs[ge->pl().getId()].size();
+  }
 
   const Grid<GridNode*, Point, double>& getGrid() const;
 
+  void initState();
+  void initCsr();
+
   virtual void writeInitialCosts();
-  virtual void writeObstacleCost(const util::geo::Polygon<double>& obst);
   virtual void reWriteObstCosts();
 
   virtual double getBendPen(size_t origI, size_t targetI) const;
@@ -149,15 +182,16 @@ class GridGraph : public BaseGraph {
 
 struct GridCost
     : public util::graph::Dijkstra::CostFunc<GridNodePL, GridEdgePL, float> {
-  GridCost(float inf) : _inf(inf) {}
+  GridCost(const BaseGraph* g, float inf) : _g(g), _inf(inf) {}
   virtual float operator()(const GridNode* from, const GridEdge* e,
                            const GridNode* to) const {
     UNUSED(from);
     UNUSED(to);
     // const_cast<GridNode*>(from)->pl().visited = true;
-    return e->pl().cost();
+    return _g->state(e).cost();
   }
 
+  const BaseGraph* _g;
   float _inf;
 
   virtual float inf() const { return _inf; }
@@ -174,7 +208,7 @@ struct GridGraphHeur
       size_t i = 0;
       for (; i < g->maxDeg(); i++) {
         if (!n->pl().getPort(i)) continue;
-        float sinkCost = g->getEdg(n->pl().getPort(i), n)->pl().cost();
+        float sinkCost = g->state(g->getEdg(n->pl().getPort(i), n)).cost();
         if (sinkCost < cheapestSink) cheapestSink = sinkCost;
         auto neigh = g->neigh(n, i);
         if (neigh && to.find(neigh) == to.end()) {
@@ -185,7 +219,7 @@ struct GridGraphHeur
       }
       for (size_t j = i; j < g->maxDeg(); j++) {
         if (!n->pl().getPort(j)) continue;
-        float sinkCost = g->getEdg(n->pl().getPort(j), n)->pl().cost();
+        float sinkCost = g->state(g->getEdg(n->pl().getPort(j), n)).cost();
         if (sinkCost < cheapestSink) cheapestSink = sinkCost;
       }
     }
@@ -211,6 +245,33 @@ struct GridGraphHeur
   float cheapestSink;
 };
 
+// inline, so that routing kernels specialized on the graph type can inline
+// the heuristic
+// _____________________________________________________________________________
+inline double GridGraph::heurCost(int64_t xa, int64_t ya, int64_t xb,
+                                  int64_t yb) const {
+  int dx = labs(xb - xa);
+  int dy = labs(yb - ya);
+
+  // Alternative: use chebyshev distance heuristic
+  // double minHops = std::max(dx, dy);
+
+  // double heurECost =
+  // (std::min(_c.verticalPen, std::min(_c.horizontalPen, _c.diagonalPen)));
+
+  // return minHops * (heurECost + _heurHopCost) - _heurHopCost;
+
+  double edgCost = ((_c.horizontalPen + _heurHopCost) * dx +
+                    (_c.verticalPen + _heurHopCost) * dy);
+
+  // we have to do at least one turn, which can only be a 90 degree turn
+  if (dx != 0 && dy != 0) edgCost += _c.p_90;
+
+  // we always count one heurHopCost too much, subtract it at the end, but
+  // dont make negative!
+  return fmax(0, edgCost - _heurHopCost);
+}
+
 }  // namespace basegraph
 }  // namespace octi
 
@@ -9,7 +9,7 @@ using namespace octi::basegraph;
 
 // _____________________________________________________________________________
 GridNodePL::GridNodePL(Point<double> pos)
-    : _pos(pos), _parent(0), _closed(false), _sink(false), _settled(false) {}
+    : _pos(pos), _parent(0), _sink(false) {}
 
 // _____________________________________________________________________________
 const Point<double>* GridNodePL::getGeom() const { return &_pos; }
@@ -18,8 +18,6 @@ const Point<double>* GridNodePL::getGeom() const { return &_pos; }
 util::json::Dict GridNodePL::getAttrs() const {
   util::json::Dict obj;
 
-  obj["settled"] = _settled ? "1" : "0";
-  obj["closed"] = _closed ? "1" : "0";
   obj["grid"] = util::toString(_id);
   obj["x"] = util::toString(_x);
   obj["y"] = util::toString(_y);
@@ -57,18 +55,6 @@ size_t GridNodePL::getX() const { return _parent->pl()._x; }
 // _____________________________________________________________________________
 size_t GridNodePL::getY() const { return _parent->pl()._y; }
 
-// _____________________________________________________________________________
-void GridNodePL::setClosed(bool c) { _closed = c; }
-
-// _____________________________________________________________________________
-bool GridNodePL::isClosed() const { return _closed; }
-
-// _____________________________________________________________________________
-void GridNodePL::setSettled(bool c) { _settled = c; }
-
-// _____________________________________________________________________________
-bool GridNodePL::isSettled() const { return _settled; }
-
 // _____________________________________________________________________________
 void GridNodePL::setSink() { _sink = true; }
 
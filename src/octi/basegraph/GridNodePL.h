@@ -38,15 +38,10 @@ class GridNodePL : util::geograph::GeoNodePL<double> {
   size_t getX() const;
   size_t getY() const;
 
-  bool isClosed() const;
-  void setClosed(bool c);
-
+  // the closed and settled flags are kept per graph in a GridNodeState
   bool isSink() const;
   void setSink();
 
-  bool isSettled() const;
-  void setSettled(bool c);
-
   void setId(size_t id);
   size_t getId() const;
 
@@ -58,9 +53,7 @@ class GridNodePL : util::geograph::GeoNodePL<double> {
 
   uint32_t _x, _y;
   uint32_t _id;
-  bool _closed : 1;
   bool _sink : 1;
-  bool _settled : 1;
 };
 }  // namespace basegraph
 }  // namespace octi
@@ -0,0 +1,96 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <algorithm>
+#include "octi/basegraph/GridRouter.h"
+
+using octi::basegraph::BaseGraph;
+using octi::basegraph::GridNode;
+using octi::basegraph::GridRouter;
+using octi::basegraph::RadixHeap;
+
+// _____________________________________________________________________________
+GridRouter& BaseGraph::getRouter() {
+  if (!_router) _router = std::make_shared<GridRouter>();
+  return *_router;
+}
+
+// _____________________________________________________________________________
+void RadixHeap::clear() {
+  for (auto& b : _buckets) b.clear();
+  _last = 0;
+  _size = 0;
+}
+
+// _____________________________________________________________________________
+void GridRouter::prepare(const BaseGraph& g, const GridNdSet& to) {
+  size_t numNds = g.getCsr().numNds();
+
+  if (_dist.size() != numNds) {
+    _reached.assign(numNds, 0);
+    _settled.assign(numNds, 0);
+    _tgt.assign(numNds, 0);
+    _heurStamp.assign(numNds, 0);
+    _dist.resize(numNds);
+    _heur.resize(numNds);
+    _pred.resize(numNds);
+    _arc.resize(numNds);
+    _epoch = 0;
+  }
+
+  _epoch++;
+
+  if (_epoch == 0) {
+    // overflow, all stamps have to be invalidated
+    std::fill(_reached.begin(), _reached.end(), 0);
+    std::fill(_settled.begin(), _settled.end(), 0);
+    std::fill(_tgt.begin(), _tgt.end(), 0);
+    std::fill(_heurStamp.begin(), _heurStamp.end(), 0);
+    _epoch = 1;
+  }
+
+  for (auto n : to) _tgt[n->pl().getId()] = _epoch;
+
+  // lower bounds from the landmarks, a landmark from which no target can be
+  // reached gives none
+  _lms = g.getLandmarks();
+  _lmBounds.clear();
+
+  if (_lms) {
+    for (size_t l = 0; l < _lms->size(); l++) {
+      float bound = std::numeric_limits<float>::infinity();
+      for (auto n : to) bound = std::min(bound, _lms->dist(l, n->pl().getId()));
+      if (bound == std::numeric_limits<float>::infinity()) continue;
+      _lmBounds.push_back({l, bound});
+    }
+  }
+
+  // hull of the target nodes, as in GridGraphHeur
+  _useHeur = g.useHullHeur();
+  _hullX.clear();
+  _hullY.clear();
+  _cheapestSink = std::numeric_limits<float>::infinity();
+
+  if (!_useHeur) return;
+
+  for (auto n : to) {
+    size_t i = 0;
+    for (; i < g.maxDeg(); i++) {
+      if (!n->pl().getPort(i)) continue;
+      float sinkCost = g.state(g.getEdg(n->pl().getPort(i), n)).cost();
+      if (sinkCost < _cheapestSink) _cheapestSink = sinkCost;
+      auto neigh = g.neigh(n, i);
+      if (neigh && _tgt[neigh->pl().getId()] != _epoch) {
+        _hullX.push_back(n->pl().getX());
+        _hullY.push_back(n->pl().getY());
+        break;
+      }
+    }
+    for (size_t j = i; j < g.maxDeg(); j++) {
+      if (!n->pl().getPort(j)) continue;
+      float sinkCost = g.state(g.getEdg(n->pl().getPort(j), n)).cost();
+      if (sinkCost < _cheapestSink) _cheapestSink = sinkCost;
+    }
+  }
+}
@@ -0,0 +1,247 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef OCTI_BASEGRAPH_GRIDROUTER_H_
+#define OCTI_BASEGRAPH_GRIDROUTER_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <set>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "octi/basegraph/BaseGraph.h"
+#include "octi/basegraph/GridCsr.h"
+#include "octi/basegraph/Landmarks.h"
+#include "util/graph/Dijkstra.h"
+
+namespace octi {
+namespace basegraph {
+
+typedef util::graph::Dijkstra::EList<GridNodePL, GridEdgePL> GridEdgList;
+typedef util::graph::Dijkstra::NList<GridNodePL, GridEdgePL> GridNdList;
+
+/*
+ * Monotone radix heap over non-negative float keys. Keys smaller than the
+ * last popped key are treated as equal to it.
+ */
+class RadixHeap {
+ public:
+  RadixHeap() : _last(0), _size(0) {}
+
+  void push(float key, uint32_t val) {
+    uint32_t k = bits(key);
+    if (k < _last) k = _last;
+    _buckets[bucket(k, _last)].push_back({k, val});
+    _size++;
+  }
+
+  uint32_t pop() {
+    if (_buckets[0].empty()) {
+      size_t i = 1;
+      while (_buckets[i].empty()) i++;
+
+      uint32_t newLast = _buckets[i][0].first;
+      for (const auto& e : _buckets[i]) {
+        if (e.first < newLast) newLast = e.first;
+      }
+
+      for (const auto& e : _buckets[i]) {
+        _buckets[bucket(e.first, newLast)].push_back(e);
+      }
+      _buckets[i].clear();
+      _last = newLast;
+    }
+
+    uint32_t ret = _buckets[0].back().second;
+    _buckets[0].pop_back();
+    _size--;
+    return ret;
+  }
+
+  bool empty() const { return _size == 0; }
+  void clear();
+
+ private:
+  // the bit pattern of a non-negative float is monotone in its value
+  static uint32_t bits(float f) {
+    if (!(f > 0)) return 0;
+    uint32_t ret;
+    std::memcpy(&ret, &f, sizeof(ret));
+    return ret;
+  }
+
+  static size_t bucket(uint32_t k, uint32_t last) {
+    return k == last ? 0 : 32 - __builtin_clz(k ^ last);
+  }
+
+  std::vector<std::pair<uint32_t, uint32_t>> _buckets[33];
+  uint32_t _last;
+  size_t _size;
+};
+
+/*
+ * A* routing engine on the CSR view of a grid graph. The search state is
+ * kept between calls and invalidated by bumping an epoch counter, so a call
+ * only touches the nodes it explores. Each BaseGraph owns one engine, which
+ * must therefore only be used by one thread at a time.
+ */
+class GridRouter {
+ public:
+  GridRouter() : _epoch(0), _useHeur(false), _cheapestSink(0), _lms(0) {}
+
+  // shortest path from all nodes in from to the nearest node in to, with
+  // the same output as util::graph::Dijkstra with g.getHeur(to). The
+  // heuristic is the one of g.getHeur(to), raised to the ALT bound if the
+  // graph has landmarks. Cost is called with an edge id, arcs whose cost would
+  // reach inf are not relaxed. Returns the path cost, or inf if no path
+  // was found. If G is the dynamic type of g, the heuristic is dispatched
+  // statically, with G = BaseGraph it goes through the virtual interface.
+  template <typename G, typename C>
+  float route(const G& g, const GridNdSet& from, const GridNdSet& to,
+              const C& cost, float inf, GridEdgList* eL, GridNdList* nL);
+
+ private:
+  uint32_t _epoch;
+
+  // a value is only valid if its stamp equals the current epoch
+  std::vector<uint32_t> _reached, _settled, _tgt, _heurStamp;
+  std::vector<float> _dist, _heur;
+  std::vector<uint32_t> _pred, _arc;
+
+  RadixHeap _pq;
+
+  bool _useHeur;
+  float _cheapestSink;
+
+  // hull of the target nodes, as separate coordinate arrays so that the
+  // minimum over the hull can be vectorized
+  std::vector<int64_t> _hullX, _hullY;
+
+  // landmarks usable for the current targets, with the minimum distance
+  // from each of them to a target
+  const Landmarks* _lms;
+  std::vector<std::pair<uint32_t, float>> _lmBounds;
+
+  void prepare(const BaseGraph& g, const GridNdSet& to);
+
+  template <typename G>
+  static float heurCost(const G& g, int64_t xa, int64_t ya, int64_t xb,
+                        int64_t yb) {
+    // a qualified call is not dispatched virtually
+    if constexpr (std::is_same<G, BaseGraph>::value) {
+      return g.heurCost(xa, ya, xb, yb);
+    } else {
+      return g.G::heurCost(xa, ya, xb, yb);
+    }
+  }
+
+  template <typename G>
+  float hullHeur(const G& g, int64_t x, int64_t y) const {
+    const int64_t* hx = _hullX.data();
+    const int64_t* hy = _hullY.data();
+    float ret = std::numeric_limits<float>::infinity();
+    for (size_t i = 0; i < _hullX.size(); i++) {
+      ret = std::min(ret, heurCost(g, x, y, hx[i], hy[i]));
+    }
+    return ret + _cheapestSink;
+  }
+
+  float altHeur(uint32_t nd) const {
+    // by the triangle inequality, d(L, t) - d(L, nd) <= d(nd, t)
+    float ret = 0;
+    for (const auto& b : _lmBounds) {
+      float d = _lms->dist(b.first, nd);
+      if (d == std::numeric_limits<float>::infinity()) continue;
+      ret = std::max(ret, b.second - d);
+    }
+    return ret;
+  }
+
+  template <typename G>
+  float heur(const G& g, uint32_t nd) {
+    if (!_useHeur && _lmBounds.empty()) return 0;
+    if (_heurStamp[nd] == _epoch) return _heur[nd];
+
+    const auto& csr = g.getCsr();
+    float ret = 0;
+
+    if (_tgt[csr.getParent(nd)] != _epoch) {
+      if (_useHeur) ret = hullHeur(g, csr.getX(nd), csr.getY(nd));
+      if (!_lmBounds.empty()) ret = std::max(ret, altHeur(nd));
+    }
+
+    _heurStamp[nd] = _epoch;
+    _heur[nd] = ret;
+    return ret;
+  }
+};
+
+// _____________________________________________________________________________
+template <typename G, typename C>
+float GridRouter::route(const G& g, const GridNdSet& from,
+                        const GridNdSet& to, const C& cost, float inf,
+                        GridEdgList* eL, GridNdList* nL) {
+  const auto& csr = g.getCsr();
+  prepare(g, to);
+
+  for (auto n : from) {
+    uint32_t id = n->pl().getId();
+    _reached[id] = _epoch;
+    _dist[id] = 0;
+    _arc[id] = GridCsr::NONE;
+    _pq.push(heur(g, id), id);
+  }
+
+  uint32_t found = GridCsr::NONE;
+
+  while (!_pq.empty()) {
+    uint32_t cur = _pq.pop();
+    if (_settled[cur] == _epoch) continue;
+    _settled[cur] = _epoch;
+
+    if (_tgt[cur] == _epoch) {
+      found = cur;
+      break;
+    }
+
+    float d = _dist[cur];
+
+    for (uint32_t a = csr.arcsBegin(cur); a < csr.arcsEnd(cur); a++) {
+      float newD = d + cost(csr.arcEdg(a));
+      if (newD >= inf) continue;
+
+      uint32_t tgt = csr.arcTo(a);
+      if (_settled[tgt] == _epoch) continue;
+      if (_reached[tgt] == _epoch && _dist[tgt] <= newD) continue;
+
+      _reached[tgt] = _epoch;
+      _dist[tgt] = newD;
+      _pred[tgt] = cur;
+      _arc[tgt] = a;
+      _pq.push(newD + heur(g, tgt), tgt);
+    }
+  }
+
+  _pq.clear();
+
+  if (found == GridCsr::NONE) return inf;
+
+  uint32_t cur = found;
+  while (true) {
+    nL->push_back(csr.getNd(cur));
+    if (_arc[cur] == GridCsr::NONE) break;
+    eL->push_back(csr.getEdg(csr.arcEdg(_arc[cur])));
+    cur = _pred[cur];
+  }
+
+  return _dist[found];
+}
+
+}  // namespace basegraph
+}  // namespace octi
+
+#endif  // OCTI_BASEGRAPH_GRIDROUTER_H_
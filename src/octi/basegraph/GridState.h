@@ -0,0 +1,107 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef OCTI_BASEGRAPH_GRIDSTATE_H_
+#define OCTI_BASEGRAPH_GRIDSTATE_H_
+
+#include <cstdint>
+#include <limits>
+
+namespace octi {
+namespace basegraph {
+
+const static double INF = std::numeric_limits<double>::infinity();
+
+const static double SOFT_INF = 100000;
+
+/*
+ * Mutable routing state of a single grid edge. The grid topology may be shared
+ * between several graphs, each of which keeps its own vector of edge states
+ * indexed by the edge id.
+ */
+class GridEdgeState {
+ public:
+  GridEdgeState() : GridEdgeState(0) {}
+  explicit GridEdgeState(double c)
+      : _c(c),
+        _closed(false),
+        _softClosed(false),
+        _blocked(false),
+        _resEdgs(0) {}
+
+  double cost() const {
+    // testing relaxed constraints for diagonal intersections
+    if (_softClosed || _blocked) return SOFT_INF + rawCost();
+    if (_closed) return INF;
+
+    return rawCost();
+  }
+
+  double rawCost() const { return _c; }
+  void setCost(double c) { _c = c; }
+
+  void close() {
+    _closed = true;
+    _softClosed = false;
+  }
+
+  void softClose() {
+    if (!_closed) _softClosed = true;
+    _closed = true;
+  }
+
+  void open() {
+    _closed = false;
+    _softClosed = false;
+  }
+
+  bool closed() const { return _closed; }
+
+  // edges are blocked if they would cross a settled edge
+  void block() { _blocked = true; }
+  void unblock() { _blocked = false; }
+
+  size_t resEdgs() const { return _resEdgs; }
+  void addResEdge() { _resEdgs++; }
+  void delResEdg() {
+    if (_resEdgs > 0) _resEdgs--;
+  }
+
+  void reset() {
+    _closed = false;
+    _resEdgs = 0;
+  }
+
+ private:
+  float _c;
+
+  bool _closed : 1;
+  bool _softClosed : 1;
+  bool _blocked : 1;
+
+  uint8_t _resEdgs : 8;
+};
+
+/*
+ * Mutable routing state of a single grid node, indexed by the node id.
+ */
+class GridNodeState {
+ public:
+  GridNodeState() : _closed(false), _settled(false) {}
+
+  bool isClosed() const { return _closed; }
+  void setClosed(bool c) { _closed = c; }
+
+  bool isSettled() const { return _settled; }
+  void setSettled(bool c) { _settled = c; }
+
+ private:
+  bool _closed : 1;
+  bool _settled : 1;
+};
+
+}  // namespace basegraph
+}  // namespace octi
+
+#endif  // OCTI_BASEGRAPH_GRIDSTATE_H_
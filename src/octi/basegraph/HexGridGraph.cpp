@@ -20,15 +20,15 @@ using util::geo::DPoint;
 // _____________________________________________________________________________
 void HexGridGraph::init() {
   // write nodes
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
       writeNd(x, y);
     }
   }
 
   // write grid edges
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
       GridNode* center = getNode(x, y);
 
       for (size_t p = 0; p < maxDeg(); p++) {
@@ -44,10 +44,15 @@ void HexGridGraph::init() {
     }
   }
 
+  initState();
   writeInitialCosts();
   prunePorts();
+  initCsr();
 }
 
+// _____________________________________________________________________________
+BaseGraph* HexGridGraph::fork() const { return new HexGridGraph(*this); }
+
 // _____________________________________________________________________________
 GridNode* HexGridGraph::neigh(size_t cx, size_t cy, size_t i) const {
   if (i > 5) return getNode(cx, cy);
@@ -110,6 +115,9 @@ HexGridGraph::getHeur(const std::set<GridNode*>& to) const {
   return new HexGridGraphHeur(this, to);
 }
 
+// _____________________________________________________________________________
+bool HexGridGraph::useHullHeur() const { return false; }
+
 // _____________________________________________________________________________
 GridEdge* HexGridGraph::getNEdg(const GridNode* a,
                                     const GridNode* b) const {
@@ -141,20 +149,14 @@ GridEdge* HexGridGraph::getNEdg(const GridNode* a,
     }
   }
 
-  if (a->pl().getPort(dir) &&
-      b->pl().getPort((dir + maxDeg() / 2) % maxDeg())) {
-    return const_cast<GridEdge*>(
-        getEdg(a->pl().getPort(dir),
-               b->pl().getPort((dir + maxDeg() / 2) % maxDeg())));
-  }
-
-  return 0;
+  return portEdg(a->pl().getPort(dir),
+                 b->pl().getPort((dir + maxDeg() / 2) % maxDeg()));
 }
 
 // _____________________________________________________________________________
 void HexGridGraph::writeInitialCosts() {
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
       auto n = getNode(x, y);
       for (size_t i = 0; i < maxDeg(); i++) {
         auto port = n->pl().getPort(i);
@@ -166,9 +168,9 @@ void HexGridGraph::writeInitialCosts() {
         auto e = getEdg(port, oPort);
 
         if (i == 1 || i == 4) {
-          e->pl().setCost(_c.horizontalPen);
+          state(e).setCost(_c.horizontalPen);
         } else {
-          e->pl().setCost(_c.diagonalPen);
+          state(e).setCost(_c.diagonalPen);
         }
       }
     }
@@ -190,7 +192,7 @@ GridNode* HexGridGraph::writeNd(size_t x, size_t y) {
 
   // we are using the raw position here, as grid cells do not reflect the
   // positions in the grid graph as in the octilinear case
-  _grid.add(pos, n);
+  _grid->add(pos, n);
   n->pl().setXY(x, y);
   n->pl().setParent(n);
 
@@ -243,8 +245,8 @@ GridNode* HexGridGraph::writeNd(size_t x, size_t y) {
 
       if (x == 0 && i == 3) pen = INF;
       if (y == 0 && i == 0) pen = INF;
-      if (x == _grid.getXWidth() - 1 && i == 1) pen = INF;
-      if (y == _grid.getYHeight() - 1 && i == 2) pen = INF;
+      if (x == _grid->getXWidth() - 1 && i == 1) pen = INF;
+      if (y == _grid->getYHeight() - 1 && i == 2) pen = INF;
 
       auto e = addEdg(n->pl().getPort(i), n->pl().getPort(j),
                             GridEdgePL(pen, true, false));
@@ -287,6 +289,6 @@ size_t HexGridGraph::ang(size_t i, size_t j) const {
 
 // _____________________________________________________________________________
 GridNode* HexGridGraph::getNode(size_t x, size_t y) const {
-  if (x >= _grid.getXWidth() || y >= _grid.getYHeight()) return 0;
-  return _nds[_grid.getYHeight() * 7 * x + y * 7];
+  if (x >= _grid->getXWidth() || y >= _grid->getYHeight()) return 0;
+  return _nds[_grid->getYHeight() * 7 * x + y * 7];
 }
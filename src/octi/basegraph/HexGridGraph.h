@@ -20,7 +20,8 @@ class HexGridGraph : public GridGraph {
       : GridGraph(bbox, cellSize, spacer, pens) {
     _a = _cellSize;
     _h = _a * A;
-    _grid = Grid<GridNode*, Point, double>(_a, _h, bbox, false);
+    _grid = std::make_shared<Grid<GridNode*, Point, double>>(_a, _h, bbox,
+                                                             false);
 
     _bendCosts[0] = _c.p_45 - _c.p_135;
     _bendCosts[2] = _c.p_45;
@@ -28,9 +29,11 @@ class HexGridGraph : public GridGraph {
   }
 
   virtual void init();
+  virtual BaseGraph* fork() const;
   virtual GridEdge* getNEdg(const GridNode* a, const GridNode* b) const;
   virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
   getHeur(const std::set<GridNode*>& to) const;
+  virtual bool useHullHeur() const;
   virtual size_t maxDeg() const;
   virtual std::vector<double> getCosts() const;
 
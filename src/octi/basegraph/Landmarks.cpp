@@ -0,0 +1,120 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include "octi/basegraph/GridCsr.h"
+#include "octi/basegraph/GridRouter.h"
+#include "octi/basegraph/Landmarks.h"
+
+using octi::basegraph::BaseGraph;
+using octi::basegraph::GridCsr;
+using octi::basegraph::Landmarks;
+using octi::basegraph::RadixHeap;
+
+namespace {
+const float LM_INF = std::numeric_limits<float>::infinity();
+
+// _____________________________________________________________________________
+uint32_t farthest(const GridCsr& csr, const std::vector<float>& dists) {
+  uint32_t ret = GridCsr::NONE;
+  float max = 0;
+  for (uint32_t i = 0; i < csr.numNds(); i++) {
+    if (!csr.getNd(i) || csr.getParent(i) != i) continue;
+    if (dists[i] == LM_INF || dists[i] <= max) continue;
+    max = dists[i];
+    ret = i;
+  }
+  return ret;
+}
+}  // namespace
+
+// _____________________________________________________________________________
+void BaseGraph::initLandmarks(size_t num) {
+  _lms.reset();
+  if (num) _lms = std::make_shared<Landmarks>(*this, num);
+}
+
+// _____________________________________________________________________________
+Landmarks::Landmarks(const BaseGraph& g, size_t num) : _num(0) {
+  const auto& csr = g.getCsr();
+  std::vector<std::vector<float>> tables;
+
+  uint32_t start = GridCsr::NONE;
+  for (uint32_t i = 0; i < csr.numNds() && start == GridCsr::NONE; i++) {
+    if (csr.getNd(i) && csr.getParent(i) == i) start = i;
+  }
+
+  if (start == GridCsr::NONE || num == 0) return;
+
+  std::vector<float> minD;
+  dijkstra(g, start, &minD);
+
+  uint32_t next = farthest(csr, minD);
+  std::fill(minD.begin(), minD.end(), LM_INF);
+
+  // every new landmark is the node farthest from all previous ones, it is
+  // unset if all remaining nodes are already at distance 0
+  while (next != GridCsr::NONE && tables.size() < num) {
+    tables.emplace_back();
+    dijkstra(g, next, &tables.back());
+
+    for (size_t i = 0; i < minD.size(); i++) {
+      if (tables.back()[i] < minD[i]) minD[i] = tables.back()[i];
+    }
+
+    next = farthest(csr, minD);
+  }
+
+  _num = tables.size();
+  _dists.resize(csr.numNds() * _num);
+
+  for (size_t l = 0; l < _num; l++) {
+    for (size_t i = 0; i < csr.numNds(); i++) {
+      _dists[i * _num + l] = tables[l][i];
+    }
+  }
+}
+
+// _____________________________________________________________________________
+void Landmarks::dijkstra(const BaseGraph& g, uint32_t src,
+                         std::vector<float>* dists) {
+  const auto& csr = g.getCsr();
+  dists->assign(csr.numNds(), LM_INF);
+
+  std::vector<bool> settled(csr.numNds(), false);
+  RadixHeap pq;
+
+  (*dists)[src] = 0;
+  pq.push(0, src);
+
+  while (!pq.empty()) {
+    uint32_t cur = pq.pop();
+    if (settled[cur]) continue;
+    settled[cur] = true;
+
+    float d = (*dists)[cur];
+
+    for (uint32_t a = csr.arcsBegin(cur); a < csr.arcsEnd(cur); a++) {
+      uint32_t e = csr.arcEdg(a);
+      float c = 0;
+
+      if (!csr.isSecondary(e)) {
+        // closed and blocked edges are only temporarily expensive, their
+        // raw cost is a lower bound. Edges with an infinite raw cost (grid
+        // border, obstacles) are never reopened.
+        c = g.edgState(e).rawCost();
+        if (c == LM_INF) continue;
+        if (c < 0) c = 0;
+      }
+
+      uint32_t tgt = csr.arcTo(a);
+      if (settled[tgt] || (*dists)[tgt] <= d + c) continue;
+
+      (*dists)[tgt] = d + c;
+      pq.push(d + c, tgt);
+    }
+  }
+}
@@ -0,0 +1,46 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef OCTI_BASEGRAPH_LANDMARKS_H_
+#define OCTI_BASEGRAPH_LANDMARKS_H_
+
+#include <cstdint>
+#include <vector>
+#include "octi/basegraph/BaseGraph.h"
+
+namespace octi {
+namespace basegraph {
+
+/*
+ * Distance tables from a few landmark nodes for the ALT heuristic of the
+ * GridRouter. Distances are taken on the CSR view, with the primary edge
+ * costs at construction time and all secondary edges at cost 0. Drawing
+ * only ever raises primary edge costs above these (settling, blocking,
+ * closing, density and geo pens all add on top), so the tables remain
+ * lower bounds and never have to be recomputed for the graph or its forks.
+ */
+class Landmarks {
+ public:
+  // num landmarks, chosen by farthest point selection among the sink nodes
+  Landmarks(const BaseGraph& g, size_t num);
+
+  size_t size() const { return _num; }
+
+  // distance from landmark l to node nd, inf if unreachable
+  float dist(size_t l, uint32_t nd) const { return _dists[nd * _num + l]; }
+
+ private:
+  size_t _num;
+
+  // node-major, so that the distances of one node share a cache line
+  std::vector<float> _dists;
+
+  static void dijkstra(const BaseGraph& g, uint32_t src,
+                       std::vector<float>* dists);
+};
+
+}  // namespace basegraph
+}  // namespace octi
+
+#endif  // OCTI_BASEGRAPH_LANDMARKS_H_
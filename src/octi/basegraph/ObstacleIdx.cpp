@@ -0,0 +1,114 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <algorithm>
+#include <cmath>
+
+#include "octi/basegraph/ObstacleIdx.h"
+
+using octi::basegraph::ObstacleIdx;
+using util::geo::DBox;
+using util::geo::DPoint;
+using util::geo::DPolygon;
+using util::geo::LineSegment;
+
+namespace {
+// _____________________________________________________________________________
+bool disjoint(const DBox& a, const DBox& b) {
+  return a.getUpperRight().getX() < b.getLowerLeft().getX() ||
+         b.getUpperRight().getX() < a.getLowerLeft().getX() ||
+         a.getUpperRight().getY() < b.getLowerLeft().getY() ||
+         b.getUpperRight().getY() < a.getLowerLeft().getY();
+}
+}  // namespace
+
+// _____________________________________________________________________________
+ObstacleIdx::ObstacleIdx(const std::vector<DPolygon>& obsts, const DBox& box)
+    : _bucketSize(1), _w(0), _h(0) {
+  for (const auto& obst : obsts) {
+    auto obstBox = util::geo::getBoundingBox(obst);
+    if (disjoint(obstBox, box)) continue;
+    _obsts.push_back(&obst);
+    _boxes.push_back(obstBox);
+    _bbox = util::geo::extendBox(obstBox, _bbox);
+  }
+
+  if (_obsts.empty()) return;
+
+  // about one obstacle per bucket if they were evenly spread, but at most
+  // 256 x 256 buckets
+  double w = _bbox.getUpperRight().getX() - _bbox.getLowerLeft().getX();
+  double h = _bbox.getUpperRight().getY() - _bbox.getLowerLeft().getY();
+  double n = std::min(256.0, std::ceil(std::sqrt(_obsts.size())));
+
+  _bucketSize = std::max(w, h) / n;
+  if (!(_bucketSize > 0)) _bucketSize = 1;
+
+  _w = bucketX(_bbox.getUpperRight().getX()) + 1;
+  _h = bucketY(_bbox.getUpperRight().getY()) + 1;
+  _buckets.resize(_w * _h);
+
+  for (size_t i = 0; i < _obsts.size(); i++) {
+    for (size_t x = bucketX(_boxes[i].getLowerLeft().getX());
+         x <= bucketX(_boxes[i].getUpperRight().getX()); x++) {
+      for (size_t y = bucketY(_boxes[i].getLowerLeft().getY());
+           y <= bucketY(_boxes[i].getUpperRight().getY()); y++) {
+        _buckets[x * _h + y].push_back(i);
+      }
+    }
+  }
+}
+
+// _____________________________________________________________________________
+size_t ObstacleIdx::bucketX(double x) const {
+  double b = std::floor((x - _bbox.getLowerLeft().getX()) / _bucketSize);
+  if (b < 0) return 0;
+  if (_w && b >= _w) return _w - 1;
+  return b;
+}
+
+// _____________________________________________________________________________
+size_t ObstacleIdx::bucketY(double y) const {
+  double b = std::floor((y - _bbox.getLowerLeft().getY()) / _bucketSize);
+  if (b < 0) return 0;
+  if (_h && b >= _h) return _h - 1;
+  return b;
+}
+
+// _____________________________________________________________________________
+bool ObstacleIdx::blocks(const DPoint& a, const DPoint& b) const {
+  if (_obsts.empty()) return false;
+
+  DBox segBox = util::geo::extendBox(b, util::geo::extendBox(a, DBox()));
+  if (disjoint(segBox, _bbox)) return false;
+
+  size_t x0 = bucketX(segBox.getLowerLeft().getX());
+  size_t x1 = bucketX(segBox.getUpperRight().getX());
+  size_t y0 = bucketY(segBox.getLowerLeft().getY());
+  size_t y1 = bucketY(segBox.getUpperRight().getY());
+
+  LineSegment<double> seg(a, b);
+
+  for (size_t x = x0; x <= x1; x++) {
+    for (size_t y = y0; y <= y1; y++) {
+      for (auto i : _buckets[x * _h + y]) {
+        // an obstacle in several of the buckets is only tested in the first
+        // one both have in common
+        if (x != std::max(x0, bucketX(_boxes[i].getLowerLeft().getX())) ||
+            y != std::max(y0, bucketY(_boxes[i].getLowerLeft().getY()))) {
+          continue;
+        }
+
+        if (disjoint(segBox, _boxes[i])) continue;
+
+        if (util::geo::intersects(seg, *_obsts[i]) ||
+            util::geo::contains(seg, *_obsts[i])) {
+          return true;
+        }
+      }
+    }
+  }
+
+  return false;
+}
@@ -0,0 +1,50 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef OCTI_BASEGRAPH_OBSTACLEIDX_H_
+#define OCTI_BASEGRAPH_OBSTACLEIDX_H_
+
+#include <cstdint>
+#include <vector>
+#include "util/geo/Geo.h"
+
+namespace octi {
+namespace basegraph {
+
+/*
+ * Bucket index over obstacle polygons, so that a grid edge is only tested
+ * against the obstacles near it. Obstacles outside the box given on
+ * construction are dropped. The polygons are not copied and must outlive
+ * the index.
+ */
+class ObstacleIdx {
+ public:
+  ObstacleIdx(const std::vector<util::geo::DPolygon>& obsts,
+              const util::geo::DBox& box);
+
+  // true if the segment from a to b intersects or lies within an obstacle
+  bool blocks(const util::geo::DPoint& a, const util::geo::DPoint& b) const;
+
+  bool empty() const { return _obsts.empty(); }
+  size_t size() const { return _obsts.size(); }
+
+ private:
+  std::vector<const util::geo::DPolygon*> _obsts;
+  std::vector<util::geo::DBox> _boxes;
+
+  util::geo::DBox _bbox;
+  double _bucketSize;
+  size_t _w, _h;
+
+  // obstacle ids per bucket, row-major
+  std::vector<std::vector<uint32_t>> _buckets;
+
+  size_t bucketX(double x) const;
+  size_t bucketY(double y) const;
+};
+
+}  // namespace basegraph
+}  // namespace octi
+
+#endif  // OCTI_BASEGRAPH_OBSTACLEIDX_H_
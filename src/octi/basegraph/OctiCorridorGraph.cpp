@@ -0,0 +1,131 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <algorithm>
+#include <cmath>
+#include "octi/basegraph/OctiCorridorGraph.h"
+
+using octi::basegraph::BaseGraph;
+using octi::basegraph::GridNode;
+using octi::basegraph::OctiCorridorGraph;
+using util::geo::DBox;
+using util::geo::dist;
+using util::geo::DLine;
+using util::geo::DPoint;
+
+// _____________________________________________________________________________
+void OctiCorridorGraph::init() {
+  _ndIdx = std::make_shared<std::unordered_map<size_t, size_t>>();
+
+  // in the same order as the full grid is written
+  auto cells = getCorridorCells();
+
+  // write nodes
+  for (const auto& c : cells) writeNd(c.first, c.second);
+
+  // write grid edges
+  for (const auto& c : cells) {
+    GridNode* center = getNode(c.first, c.second);
+
+    for (size_t p = 0; p < maxDeg(); p++) {
+      GridNode* frN = center->pl().getPort(p);
+      GridNode* toN = neigh(c.first, c.second, p);
+      if (frN && toN) {
+        GridNode* to = toN->pl().getPort((p + maxDeg() / 2) % maxDeg());
+        auto e = addEdg(frN, to, GridEdgePL(9, false, false));
+        e->pl().setId(_edgeCount);
+        _edgeCount++;
+      }
+    }
+  }
+
+  initState();
+  writeInitialCosts();
+  prunePorts();
+  initCsr();
+}
+
+// _____________________________________________________________________________
+BaseGraph* OctiCorridorGraph::fork() const {
+  return new OctiCorridorGraph(*this);
+}
+
+// _____________________________________________________________________________
+std::set<std::pair<size_t, size_t>> OctiCorridorGraph::getCorridorCells()
+    const {
+  std::set<std::pair<size_t, size_t>> ret;
+
+  for (auto nd : _cg.getNds()) {
+    addCorridorCells(*nd->pl().getGeom(), *nd->pl().getGeom(), &ret);
+
+    for (auto e : nd->getAdjList()) {
+      if (e->getFrom() != nd) continue;
+      for (auto orE : e->pl().getChilds()) {
+        const auto& l = *orE->pl().getGeom();
+        for (size_t i = 1; i < l.size(); i++) {
+          addCorridorCells(l[i - 1], l[i], &ret);
+        }
+      }
+    }
+  }
+
+  return ret;
+}
+
+// _____________________________________________________________________________
+void OctiCorridorGraph::addCorridorCells(
+    const DPoint& a, const DPoint& b,
+    std::set<std::pair<size_t, size_t>>* cells) const {
+  double maxD = _corridorCells * _cellSize;
+
+  // split long segments, their bounding boxes would cover too many cells
+  size_t steps = std::max(1.0, std::ceil(dist(a, b) / maxD));
+
+  for (size_t i = 0; i < steps; i++) {
+    DPoint p(a.getX() + (b.getX() - a.getX()) * i / steps,
+             a.getY() + (b.getY() - a.getY()) * i / steps);
+    DPoint q(a.getX() + (b.getX() - a.getX()) * (i + 1) / steps,
+             a.getY() + (b.getY() - a.getY()) * (i + 1) / steps);
+    DLine seg{p, q};
+
+    double llX = _bbox.getLowerLeft().getX();
+    double llY = _bbox.getLowerLeft().getY();
+
+    int64_t xFr = std::floor((std::min(p.getX(), q.getX()) - maxD - llX) /
+                             _cellSize);
+    int64_t xTo = std::ceil((std::max(p.getX(), q.getX()) + maxD - llX) /
+                            _cellSize);
+    int64_t yFr = std::floor((std::min(p.getY(), q.getY()) - maxD - llY) /
+                             _cellSize);
+    int64_t yTo = std::ceil((std::max(p.getY(), q.getY()) + maxD - llY) /
+                            _cellSize);
+
+    xFr = std::max<int64_t>(xFr, 0);
+    yFr = std::max<int64_t>(yFr, 0);
+    xTo = std::min<int64_t>(xTo, _grid->getXWidth() - 1);
+    yTo = std::min<int64_t>(yTo, _grid->getYHeight() - 1);
+
+    for (int64_t x = xFr; x <= xTo; x++) {
+      for (int64_t y = yFr; y <= yTo; y++) {
+        DPoint cell(llX + x * _cellSize, llY + y * _cellSize);
+        if (dist(seg, cell) <= maxD) cells->insert({x, y});
+      }
+    }
+  }
+}
+
+// _____________________________________________________________________________
+GridNode* OctiCorridorGraph::writeNd(size_t x, size_t y) {
+  auto n = OctiGridGraph::writeNd(x, y);
+  (*_ndIdx)[x * _grid->getYHeight() + y] = n->pl().getId();
+  return n;
+}
+
+// _____________________________________________________________________________
+GridNode* OctiCorridorGraph::getNode(size_t x, size_t y) const {
+  if (x >= _grid->getXWidth() || y >= _grid->getYHeight()) return 0;
+  auto i = _ndIdx->find(x * _grid->getYHeight() + y);
+  if (i == _ndIdx->end()) return 0;
+  return _nds[i->second];
+}
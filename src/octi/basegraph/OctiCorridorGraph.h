@@ -0,0 +1,54 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef OCTI_BASEGRAPH_OCTICORRIDORGRAPH_H_
+#define OCTI_BASEGRAPH_OCTICORRIDORGRAPH_H_
+
+#include <memory>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include "octi/basegraph/OctiGridGraph.h"
+
+namespace octi {
+namespace basegraph {
+
+/*
+ * Octilinear grid graph which only materializes the cells within
+ * corridorCells grid cells of the input geometry. Inside this corridor, the
+ * graph is identical to an OctiGridGraph on the same bounding box.
+ */
+class OctiCorridorGraph : public OctiGridGraph {
+ public:
+  using OctiGridGraph::neigh;
+  OctiCorridorGraph(const util::geo::DBox& bbox,
+                    const combgraph::CombGraph& cg, double cellSize,
+                    double spacer, size_t corridorCells,
+                    const Penalties& pens)
+      : OctiGridGraph(bbox, cellSize, spacer, pens),
+        _cg(cg),
+        _corridorCells(corridorCells) {}
+
+  virtual void init();
+  virtual BaseGraph* fork() const;
+
+ protected:
+  virtual GridNode* writeNd(size_t x, size_t y);
+  virtual GridNode* getNode(size_t x, size_t y) const;
+
+  std::set<std::pair<size_t, size_t>> getCorridorCells() const;
+  void addCorridorCells(const util::geo::DPoint& a, const util::geo::DPoint& b,
+                        std::set<std::pair<size_t, size_t>>* cells) const;
+
+  const combgraph::CombGraph& _cg;
+  size_t _corridorCells;
+
+  // cell index -> node id of the materialized cells. Part of the topology,
+  // shared between forks
+  std::shared_ptr<std::unordered_map<size_t, size_t>> _ndIdx;
+};
+}  // namespace basegraph
+}  // namespace octi
+
+#endif  // OCTI_BASEGRAPH_OCTICORRIDORGRAPH_H_
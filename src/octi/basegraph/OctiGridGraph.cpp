@@ -43,20 +43,20 @@ void OctiGridGraph::unSettleEdg(CombEdge* ce, GridNode* a, GridNode* b) {
   assert(ge);
   assert(gf);
 
-  ge->pl().delResEdg();
-  gf->pl().delResEdg();
+  state(ge).delResEdg();
+  state(gf).delResEdg();
 
-  _resEdgs[ge].erase(ce);
-  _resEdgs[gf].erase(ce);
+  delResEdg(ge, ce);
+  delResEdg(gf, ce);
 
-  if (_resEdgs[ge].size() == 0) {
-    if (!a->pl().isSettled()) openTurns(a);
-    if (!b->pl().isSettled()) openTurns(b);
+  if (numResEdgs(ge) == 0) {
+    if (!state(a).isSettled()) openTurns(a);
+    if (!state(b).isSettled()) openTurns(b);
   }
 
   // unblock blocked diagonal edges crossing this edge
   size_t dir = getDir(a, b);
-  if (dir % 2 != 0 && _resEdgs[ge].size() == 0) {
+  if (dir % 2 != 0 && numResEdgs(ge) == 0) {
     size_t x = a->pl().getX();
     size_t y = a->pl().getY();
 
@@ -67,8 +67,8 @@ void OctiGridGraph::unSettleEdg(CombEdge* ce, GridNode* a, GridNode* b) {
       auto e = getNEdg(na, nb);
       auto f = getNEdg(nb, na);
 
-      e->pl().unblock();
-      f->pl().unblock();
+      state(e).unblock();
+      state(f).unblock();
     }
   }
 }
@@ -116,8 +116,8 @@ void OctiGridGraph::settleEdg(GridNode* a, GridNode* b, CombEdge* e) {
       auto e = getNEdg(na, nb);
       auto f = getNEdg(nb, na);
 
-      e->pl().block();
-      f->pl().block();
+      state(e).block();
+      state(f).block();
     }
   }
 }
@@ -156,7 +156,7 @@ size_t OctiGridGraph::getDir(const GridNode* a, const GridNode* b) const {
 CrossEdgPairs OctiGridGraph::getCrossEdgPairs() const {
   CrossEdgPairs ret;
 
-  for (const GridNode* n : getNds()) {
+  for (const GridNode* n : getGrNds()) {
     if (!n->pl().isSink()) continue;
 
     auto eOr = getNEdg(n, neigh(n, 3));
@@ -187,28 +187,32 @@ std::vector<double> OctiGridGraph::getCosts() const {
   return ret;
  }
 
+// _____________________________________________________________________________
+BaseGraph* OctiGridGraph::fork() const { return new OctiGridGraph(*this); }
+
 // _____________________________________________________________________________
 void OctiGridGraph::writeInitialCosts() {
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
-      auto n = getNode(x, y);
-      if (!n) continue;
-      for (size_t i = 0; i < maxDeg(); i++) {
-        auto port = n->pl().getPort(i);
-        auto neighbor = neigh(x, y, i);
-
-        if (!neighbor || !port) continue;
-
-        auto oPort = neighbor->pl().getPort((i + maxDeg() / 2) % maxDeg());
-        auto e = getEdg(port, oPort);
-
-        if (i % 4 == 0) {
-          e->pl().setCost(_c.verticalPen);
-        } else if ((i + 2) % 4 == 0) {
-          e->pl().setCost(_c.horizontalPen);
-        } else if (i % 2) {
-          e->pl().setCost(_c.diagonalPen);
-        }
+  // only visit materialized cells, the grid may be sparse
+  for (auto n : getGrNds()) {
+    if (!n->pl().isSink()) continue;
+    size_t x = n->pl().getX();
+    size_t y = n->pl().getY();
+
+    for (size_t i = 0; i < maxDeg(); i++) {
+      auto port = n->pl().getPort(i);
+      auto neighbor = neigh(x, y, i);
+
+      if (!neighbor || !port) continue;
+
+      auto oPort = neighbor->pl().getPort((i + maxDeg() / 2) % maxDeg());
+      auto e = getEdg(port, oPort);
+
+      if (i % 4 == 0) {
+        state(e).setCost(_c.verticalPen);
+      } else if ((i + 2) % 4 == 0) {
+        state(e).setCost(_c.horizontalPen);
+      } else if (i % 2) {
+        state(e).setCost(_c.diagonalPen);
       }
     }
   }
@@ -220,14 +224,8 @@ GridEdge* OctiGridGraph::getNEdg(const GridNode* a, const GridNode* b) const {
 
   size_t dir = getDir(a, b);
 
-  if (a->pl().getPort(dir) &&
-      b->pl().getPort((dir + maxDeg() / 2) % maxDeg())) {
-    return const_cast<GridEdge*>(
-        getEdg(a->pl().getPort(dir),
-               b->pl().getPort((dir + maxDeg() / 2) % maxDeg())));
-  }
-
-  return 0;
+  return portEdg(a->pl().getPort(dir),
+                 b->pl().getPort((dir + maxDeg() / 2) % maxDeg()));
 }
 
 // _____________________________________________________________________________
@@ -239,7 +237,7 @@ GridNode* OctiGridGraph::writeNd(size_t x, size_t y) {
   n->pl().setId(_nds.size());
   _nds.push_back(n);
   n->pl().setSink();
-  _grid.add(x, y, n);
+  _grid->add(x, y, n);
   n->pl().setXY(x, y);
   n->pl().setParent(n);
 
@@ -271,8 +269,9 @@ GridNode* OctiGridGraph::writeNd(size_t x, size_t y) {
 
       if (x == 0 && (i == 5 || i == 6 || i == 7)) pen = INF;
       if (y == 0 && (i == 0 || i == 7 || i == 1)) pen = INF;
-      if (x == _grid.getXWidth() - 1 && (i == 1 || i == 2 || i == 3)) pen = INF;
-      if (y == _grid.getYHeight() - 1 && (i == 3 || i == 4 || i == 5))
+      if (x == _grid->getXWidth() - 1 && (i == 1 || i == 2 || i == 3))
+        pen = INF;
+      if (y == _grid->getYHeight() - 1 && (i == 3 || i == 4 || i == 5))
         pen = INF;
 
       auto e = addEdg(n->pl().getPort(i), n->pl().getPort(j),
@@ -295,37 +294,8 @@ size_t OctiGridGraph::maxDeg() const { return 8; }
 
 // _____________________________________________________________________________
 GridNode* OctiGridGraph::getNode(size_t x, size_t y) const {
-  if (x >= _grid.getXWidth() || y >= _grid.getYHeight()) return 0;
-  return _nds[_grid.getYHeight() * 9 * x + y * 9];
-}
-
-// _____________________________________________________________________________
-double OctiGridGraph::heurCost(int64_t xa, int64_t ya, int64_t xb,
-                               int64_t yb) const {
-  int dx = labs(xb - xa);
-  int dy = labs(yb - ya);
-
-  // cost without using diagonals
-  // we can take at most min(dx, dy) diagonal edges. Each diagonal edge saves us
-  // one horizontal and one vertical edge, but costs a diagonal edge
-  double edgeCost =
-      _heurXCost * dx + _heurYCost * dy + _heurDiagSave * std::min(dx, dy);
-
-  // we have to do at least one turn!
-  if (dx != dy && dx != 0 && dy != 0) edgeCost += _c.p_135;
-
-  // // Worse alternative: use a chebyshev distance heuristic
-  // double minHops = std::max(dx, dy);
-  // double heurECost =
-  // (std::min(_c.verticalPen, std::min(_c.horizontalPen, _c.diagonalPen)));
-
-  // double cc = minHops * (heurECost + _heurHopCost) - _heurHopCost;
-
-  // return cc;
-
-  // we always count one heurHopCost too much, subtract it at the end, but
-  // dont make negative
-  return fmax(0, edgeCost - _heurHopCost);
+  if (x >= _grid->getXWidth() || y >= _grid->getYHeight()) return 0;
+  return _nds[_grid->getYHeight() * 9 * x + y * 9];
 }
 
 // _____________________________________________________________________________
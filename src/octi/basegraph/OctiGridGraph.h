@@ -5,6 +5,9 @@
 #ifndef OCTI_BASEGRAPH_OCTIGRIDGRAPH_H_
 #define OCTI_BASEGRAPH_OCTIGRIDGRAPH_H_
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include "octi/basegraph/GridGraph.h"
 
 namespace octi {
@@ -51,6 +54,7 @@ class OctiGridGraph : public GridGraph {
     }
   }
 
+  virtual BaseGraph* fork() const;
   virtual void unSettleEdg(CombEdge* ce, GridNode* a, GridNode* b);
   virtual void settleEdg(GridNode* a, GridNode* b, CombEdge* e);
   virtual CrossEdgPairs getCrossEdgPairs() const;
@@ -59,6 +63,7 @@ class OctiGridGraph : public GridGraph {
   virtual double ndMovePen(const CombNode* cbNd, const GridNode* grNd) const;
   virtual size_t getDir(const GridNode* a, const GridNode* b) const;
   virtual std::vector<double> getCosts() const;
+  virtual double heurCost(int64_t xa, int64_t ya, int64_t xb, int64_t yb) const;
 
  protected:
   virtual void writeInitialCosts();
@@ -67,7 +72,6 @@ class OctiGridGraph : public GridGraph {
   virtual GridNode* getNode(size_t x, size_t y) const;
   virtual double getBendPen(size_t i, size_t j) const;
   virtual size_t ang(size_t i, size_t j) const;
-  virtual double heurCost(int64_t xa, int64_t ya, int64_t xb, int64_t yb) const;
 
   double _heurDiagSave;
   double _heurXCost;
@@ -76,6 +80,36 @@ class OctiGridGraph : public GridGraph {
 
   double _bendCosts[4];
 };
+
+// _____________________________________________________________________________
+inline double OctiGridGraph::heurCost(int64_t xa, int64_t ya, int64_t xb,
+                                      int64_t yb) const {
+  int dx = labs(xb - xa);
+  int dy = labs(yb - ya);
+
+  // cost without using diagonals
+  // we can take at most min(dx, dy) diagonal edges. Each diagonal edge saves us
+  // one horizontal and one vertical edge, but costs a diagonal edge
+  double edgeCost =
+      _heurXCost * dx + _heurYCost * dy + _heurDiagSave * std::min(dx, dy);
+
+  // we have to do at least one turn!
+  if (dx != dy && dx != 0 && dy != 0) edgeCost += _c.p_135;
+
+  // // Worse alternative: use a chebyshev distance heuristic
+  // double minHops = std::max(dx, dy);
+  // double heurECost =
+  // (std::min(_c.verticalPen, std::min(_c.horizontalPen, _c.diagonalPen)));
+
+  // double cc = minHops * (heurECost + _heurHopCost) - _heurHopCost;
+
+  // return cc;
+
+  // we always count one heurHopCost too much, subtract it at the end, but
+  // dont make negative
+  return fmax(0, edgeCost - _heurHopCost);
+}
+
 }  // namespace basegraph
 }  // namespace octi
 
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <fstream>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include "octi/basegraph/NodeCost.h"
@@ -21,7 +22,7 @@ using util::geo::DPoint;
 
 // _____________________________________________________________________________
 GridNode* OctiHananGraph::neigh(size_t cx, size_t cy, size_t i) const {
-  auto a = _ndIdx[cx * _grid.getYHeight() + cy];
+  auto a = _ndIdx[cx * _grid->getYHeight() + cy];
   if (!a) return 0;
 
   if (i > 7) return _nds[a - 1];
@@ -38,24 +39,22 @@ void OctiHananGraph::unSettleEdg(CombEdge* ce, GridNode* a, GridNode* b) {
   assert(ge);
   assert(gf);
 
-  ge->pl().delResEdg();
-  gf->pl().delResEdg();
+  state(ge).delResEdg();
+  state(gf).delResEdg();
 
-  _resEdgs[ge].erase(ce);
-  _resEdgs[gf].erase(ce);
+  delResEdg(ge, ce);
+  delResEdg(gf, ce);
 
-  if (_resEdgs[ge].size() == 0) {
-    if (!a->pl().isSettled() && unused(a)) openTurns(a);
-    if (!b->pl().isSettled() && unused(b)) openTurns(b);
+  if (numResEdgs(ge) == 0) {
+    if (!state(a).isSettled() && unused(a)) openTurns(a);
+    if (!state(b).isSettled() && unused(b)) openTurns(b);
   }
 
   // unblock blocked diagonal edges crossing this edge
-  if (getDir(a, b) % 2 != 0 && _resEdgs[ge].size() == 0) {
-    auto pairs = _edgePairs.find(ge);
-    if (pairs == _edgePairs.end()) return;
-    for (auto p : pairs->second) {
-      p.first->pl().unblock();
-      p.second->pl().unblock();
+  if (getDir(a, b) % 2 != 0 && numResEdgs(ge) == 0) {
+    for (const auto& p : crossing(ge)) {
+      state(p.first).unblock();
+      state(p.second).unblock();
     }
   }
 }
@@ -97,11 +96,9 @@ void OctiHananGraph::settleEdg(GridNode* a, GridNode* b, CombEdge* e) {
 
   // block diagonal edges crossing this edge
   if (getDir(a, b) % 2 != 0) {
-    auto pairs = _edgePairs.find(ge);
-    if (pairs == _edgePairs.end()) return;
-    for (auto p : pairs->second) {
-      p.first->pl().block();
-      p.second->pl().block();
+    for (const auto& p : crossing(ge)) {
+      state(p.first).block();
+      state(p.second).block();
     }
   }
 }
@@ -111,7 +108,7 @@ CrossEdgPairs OctiHananGraph::getCrossEdgPairs() const {
   CrossEdgPairs ret;
   std::unordered_map<const GridEdge*, std::set<const GridEdge*>> have;
 
-  for (const GridNode* n : getNds()) {
+  for (const GridNode* n : getGrNds()) {
     if (!n->pl().isSink()) continue;
 
     auto eOr = getNEdg(n, neigh(n, 3));
@@ -119,11 +116,7 @@ CrossEdgPairs OctiHananGraph::getCrossEdgPairs() const {
 
     if (!eOr) continue;
 
-    auto pairs = _edgePairs.find(eOr);
-    if (pairs == _edgePairs.end()) continue;
-
-
-    for (const auto& p : pairs->second) {
+    for (const auto& p : crossing(eOr)) {
       ret.push_back({{eOr, fOr}, p});
     }
   }
@@ -137,14 +130,8 @@ GridEdge* OctiHananGraph::getNEdg(const GridNode* a, const GridNode* b) const {
 
   size_t dir = getDir(a, b);
 
-  if (a->pl().getPort(dir) &&
-      b->pl().getPort((dir + maxDeg() / 2) % maxDeg())) {
-    return const_cast<GridEdge*>(
-        getEdg(a->pl().getPort(dir),
-               b->pl().getPort((dir + maxDeg() / 2) % maxDeg())));
-  }
-
-  return 0;
+  return portEdg(a->pl().getPort(dir),
+                 b->pl().getPort((dir + maxDeg() / 2) % maxDeg()));
 }
 
 // _____________________________________________________________________________
@@ -152,14 +139,14 @@ void OctiHananGraph::init() {
   std::vector<GridNode*> xSorted;
   std::vector<GridNode*> ySorted;
 
-  _ndIdx.resize(_grid.getXWidth() * _grid.getYHeight());
+  _ndIdx.resize(_grid->getXWidth() * _grid->getYHeight());
 
   std::set<std::pair<size_t, size_t>> coords;
 
   // get coords
   for (auto cNd : _cg.getNds()) {
-    int x = _grid.getCellXFromX(cNd->pl().getGeom()->getX());
-    int y = _grid.getCellYFromY(cNd->pl().getGeom()->getY());
+    int x = _grid->getCellXFromX(cNd->pl().getGeom()->getX());
+    int y = _grid->getCellYFromY(cNd->pl().getGeom()->getY());
     coords.insert({x, y});
   }
 
@@ -190,15 +177,19 @@ void OctiHananGraph::init() {
     }
   } sortByY;
 
-  if (xSorted.size() == 0) return;
+  if (xSorted.size() == 0) {
+    initState();
+    initCsr();
+    return;
+  }
 
-  std::vector<std::vector<GridNode*>> yAct(_grid.getYHeight());
-  std::vector<std::vector<GridNode*>> xAct(_grid.getXWidth());
+  std::vector<std::vector<GridNode*>> yAct(_grid->getYHeight());
+  std::vector<std::vector<GridNode*>> xAct(_grid->getXWidth());
 
-  std::vector<std::vector<GridNode*>> xyAct(_grid.getXWidth() +
-                                            _grid.getYHeight());
-  std::vector<std::vector<GridNode*>> yxAct(_grid.getXWidth() +
-                                            _grid.getYHeight());
+  std::vector<std::vector<GridNode*>> xyAct(_grid->getXWidth() +
+                                            _grid->getYHeight());
+  std::vector<std::vector<GridNode*>> yxAct(_grid->getXWidth() +
+                                            _grid->getYHeight());
 
   for (auto nd : xSorted) {
     yAct[nd->pl().getY()].push_back(nd);
@@ -209,7 +200,7 @@ void OctiHananGraph::init() {
   }
 
   for (auto nd : xSorted) {
-    xyAct[nd->pl().getX() + (_grid.getYHeight() - 1 - nd->pl().getY())]
+    xyAct[nd->pl().getX() + (_grid->getYHeight() - 1 - nd->pl().getY())]
         .push_back(nd);
   }
 
@@ -217,10 +208,10 @@ void OctiHananGraph::init() {
     yxAct[nd->pl().getY() + nd->pl().getX()].push_back(nd);
   }
 
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
     if (!xAct[x].size()) continue;
 
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
       if (!yAct[y].size()) continue;
       if (getNode(x, y)) continue;
       auto newNd = writeNd(x, y);
@@ -229,9 +220,9 @@ void OctiHananGraph::init() {
     }
   }
 
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
-      size_t xi = x + (_grid.getYHeight() - 1 - y);
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
+      size_t xi = x + (_grid->getYHeight() - 1 - y);
       size_t yi = y + x;
       if ((xyAct[xi].size() &&
            (yxAct[yi].size() || yAct[y].size() || xAct[x].size())) ||
@@ -268,15 +259,15 @@ void OctiHananGraph::init() {
     }
   }
 
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
     std::sort(xAct[x].begin(), xAct[x].end(), sortByY);
   }
 
-  for (size_t y = 0; y < _grid.getYHeight(); y++) {
+  for (size_t y = 0; y < _grid->getYHeight(); y++) {
     std::sort(yAct[y].begin(), yAct[y].end(), sortByX);
   }
 
-  for (size_t i = 0; i < _grid.getYHeight() + _grid.getXWidth(); i++) {
+  for (size_t i = 0; i < _grid->getYHeight() + _grid->getXWidth(); i++) {
     std::sort(xyAct[i].begin(), xyAct[i].end(), sortByY);
     std::sort(yxAct[i].begin(), yxAct[i].end(), sortByX);
   }
@@ -285,32 +276,34 @@ void OctiHananGraph::init() {
   // init the _neighs size
   _neighs.resize(_nds.size() * 8);
 
-  for (size_t y = 0; y < _grid.getYHeight(); y++) {
+  for (size_t y = 0; y < _grid->getYHeight(); y++) {
     for (size_t i = 1; i < yAct[y].size(); i++) {
       connectNodes(yAct[y][i - 1], yAct[y][i], 2);
     }
   }
 
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
     for (size_t i = 1; i < xAct[x].size(); i++) {
       connectNodes(xAct[x][i - 1], xAct[x][i], 0);
     }
   }
 
-  for (size_t xi = 0; xi < _grid.getXWidth() + _grid.getYHeight(); xi++) {
+  for (size_t xi = 0; xi < _grid->getXWidth() + _grid->getYHeight(); xi++) {
     for (size_t i = 1; i < xyAct[xi].size(); i++) {
       connectNodes(xyAct[xi][i - 1], xyAct[xi][i], 1);
     }
   }
 
-  for (size_t yi = 0; yi < _grid.getXWidth() + _grid.getYHeight(); yi++) {
+  for (size_t yi = 0; yi < _grid->getXWidth() + _grid->getYHeight(); yi++) {
     for (size_t i = 1; i < yxAct[yi].size(); i++) {
       connectNodes(yxAct[yi][i - 1], yxAct[yi][i], 3);
     }
   }
 
   // diagonal intersections
-  for (size_t i = 0; i < _grid.getXWidth() + _grid.getYHeight(); i++) {
+  auto edgePairs =
+      std::make_shared<std::vector<std::vector<EdgPair>>>(_edgeCount);
+  for (size_t i = 0; i < _grid->getXWidth() + _grid->getYHeight(); i++) {
     for (size_t j = 1; j < xyAct[i].size(); j++) {
       auto ndA = xyAct[i][j - 1];
       auto ndB = xyAct[i][j];
@@ -335,20 +328,36 @@ void OctiHananGraph::init() {
           auto fa = getNEdg(oNdA, oNdB);
           auto fb = getNEdg(oNdB, oNdA);
 
-          _edgePairs[ea].push_back({fa, fb});
-          _edgePairs[eb].push_back({fa, fb});
+          if (!ea || !eb || !fa || !fb) continue;
+
+          (*edgePairs)[ea->pl().getId()].push_back({fa, fb});
+          (*edgePairs)[eb->pl().getId()].push_back({fa, fb});
 
-          _edgePairs[fa].push_back({ea, eb});
-          _edgePairs[fb].push_back({ea, eb});
+          (*edgePairs)[fa->pl().getId()].push_back({ea, eb});
+          (*edgePairs)[fb->pl().getId()].push_back({ea, eb});
         }
       }
     }
   }
 
+  _edgePairs = edgePairs;
+
   prunePorts();
+  initState();
   writeInitialCosts();
+  initCsr();
 }
 
+// _____________________________________________________________________________
+const std::vector<EdgPair>& OctiHananGraph::crossing(const GridEdge* e) const {
+  static const std::vector<EdgPair> none;
+  if (!_edgePairs || e->pl().getId() >= _edgePairs->size()) return none;
+  return (*_edgePairs)[e->pl().getId()];
+}
+
+// _____________________________________________________________________________
+BaseGraph* OctiHananGraph::fork() const { return new OctiHananGraph(*this); }
+
 // _____________________________________________________________________________
 void OctiHananGraph::connectNodes(GridNode* grNdFr, GridNode* grNdTo,
                                   size_t p) {
@@ -371,7 +380,7 @@ void OctiHananGraph::connectNodes(GridNode* grNdFr, GridNode* grNdTo,
 
 // _____________________________________________________________________________
 void OctiHananGraph::writeInitialCosts() {
-  for (auto n : getNds()) {
+  for (auto n : getGrNds()) {
       if (!n->pl().isSink()) continue;
       for (size_t p = 0; p < maxDeg(); p++) {
         auto port = n->pl().getPort(p);
@@ -394,7 +403,7 @@ void OctiHananGraph::writeInitialCosts() {
         else if (p % 2)
           cost = (_c.diagonalPen + _heurHopCost) * yDist - _heurHopCost;
 
-        e->pl().setCost(cost);
+        state(e).setCost(cost);
       }
     }
 }
@@ -407,9 +416,9 @@ GridNode* OctiHananGraph::writeNd(size_t x, size_t y) {
   GridNode* n = addNd(DPoint(xPos, yPos));
   n->pl().setId(_nds.size());
   _nds.push_back(n);
-  _ndIdx[x * _grid.getYHeight() + y] = _nds.size();
+  _ndIdx[x * _grid->getYHeight() + y] = _nds.size();
   n->pl().setSink();
-  _grid.add(x, y, n);
+  _grid->add(x, y, n);
   n->pl().setXY(x, y);
   n->pl().setParent(n);
 
@@ -441,8 +450,9 @@ GridNode* OctiHananGraph::writeNd(size_t x, size_t y) {
 
       if (x == 0 && (i == 5 || i == 6 || i == 7)) pen = INF;
       if (y == 0 && (i == 0 || i == 7 || i == 1)) pen = INF;
-      if (x == _grid.getXWidth() - 1 && (i == 1 || i == 2 || i == 3)) pen = INF;
-      if (y == _grid.getYHeight() - 1 && (i == 3 || i == 4 || i == 5))
+      if (x == _grid->getXWidth() - 1 && (i == 1 || i == 2 || i == 3))
+        pen = INF;
+      if (y == _grid->getYHeight() - 1 && (i == 3 || i == 4 || i == 5))
         pen = INF;
 
       auto e = addEdg(n->pl().getPort(i), n->pl().getPort(j),
@@ -465,7 +475,7 @@ size_t OctiHananGraph::maxDeg() const { return 8; }
 
 // _____________________________________________________________________________
 GridNode* OctiHananGraph::getNode(size_t x, size_t y) const {
-  auto a = _ndIdx[x * _grid.getYHeight() + y];
+  auto a = _ndIdx[x * _grid->getYHeight() + y];
   if (a == 0) return 0;
   return _nds[a - 1];
 }
@@ -521,13 +531,13 @@ std::set<std::pair<size_t, size_t>> OctiHananGraph::getIterCoords(const std::set
     ySorted.push_back(coord);
   }
 
-  std::vector<std::vector<std::pair<size_t, size_t>>> yAct(_grid.getYHeight());
-  std::vector<std::vector<std::pair<size_t, size_t>>> xAct(_grid.getXWidth());
+  std::vector<std::vector<std::pair<size_t, size_t>>> yAct(_grid->getYHeight());
+  std::vector<std::vector<std::pair<size_t, size_t>>> xAct(_grid->getXWidth());
 
-  std::vector<std::vector<std::pair<size_t, size_t>>> xyAct(_grid.getXWidth() +
-                                            _grid.getYHeight());
-  std::vector<std::vector<std::pair<size_t, size_t>>> yxAct(_grid.getXWidth() +
-                                            _grid.getYHeight());
+  std::vector<std::vector<std::pair<size_t, size_t>>> xyAct(_grid->getXWidth() +
+                                            _grid->getYHeight());
+  std::vector<std::vector<std::pair<size_t, size_t>>> yxAct(_grid->getXWidth() +
+                                            _grid->getYHeight());
 
   for (auto c : xSorted) {
     yAct[c.second].push_back(c);
@@ -538,7 +548,7 @@ std::set<std::pair<size_t, size_t>> OctiHananGraph::getIterCoords(const std::set
   }
 
   for (auto c : xSorted) {
-    xyAct[c.first + (_grid.getYHeight() - 1 - c.second)]
+    xyAct[c.first + (_grid->getYHeight() - 1 - c.second)]
         .push_back(c);
   }
 
@@ -546,10 +556,10 @@ std::set<std::pair<size_t, size_t>> OctiHananGraph::getIterCoords(const std::set
     yxAct[c.second + c.first].push_back(c);
   }
 
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
     if (!xAct[x].size()) continue;
 
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
       if (!yAct[y].size()) continue;
       if (ret.count({x, y})) continue;
       ret.insert({x, y});
@@ -558,9 +568,9 @@ std::set<std::pair<size_t, size_t>> OctiHananGraph::getIterCoords(const std::set
     }
   }
 
-  for (size_t x = 0; x < _grid.getXWidth(); x++) {
-    for (size_t y = 0; y < _grid.getYHeight(); y++) {
-      size_t xi = x + (_grid.getYHeight() - 1 - y);
+  for (size_t x = 0; x < _grid->getXWidth(); x++) {
+    for (size_t y = 0; y < _grid->getYHeight(); y++) {
+      size_t xi = x + (_grid->getYHeight() - 1 - y);
       size_t yi = y + x;
       if ((xyAct[xi].size() &&
            (yxAct[yi].size() || yAct[y].size() || xAct[x].size())) ||
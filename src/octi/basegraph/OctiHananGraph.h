@@ -25,6 +25,7 @@ class OctiHananGraph : public OctiGridGraph {
   virtual size_t maxDeg() const;
   virtual double ndMovePen(const CombNode* cbNd, const GridNode* grNd) const;
   virtual void init();
+  virtual BaseGraph* fork() const;
 
  protected:
   virtual GridNode* writeNd(size_t x, size_t y);
@@ -42,7 +43,11 @@ class OctiHananGraph : public OctiGridGraph {
   std::vector<size_t> _ndIdx;
   std::vector<GridNode*> _neighs;
 
-  std::map<GridEdge*, std::vector<std::pair<GridEdge*, GridEdge*>>> _edgePairs;
+  // the diagonal edge pairs crossing each grid edge, indexed by the edge id
+  // and shared between forks
+  std::shared_ptr<const std::vector<std::vector<EdgPair>>> _edgePairs;
+
+  const std::vector<EdgPair>& crossing(const GridEdge* e) const;
 };
 }  // namespace basegraph
 }  // namespace octi
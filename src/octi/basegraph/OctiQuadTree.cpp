@@ -33,15 +33,15 @@ void OctiQuadTree::unSettleEdg(CombEdge* ce, GridNode* a, GridNode* b) {
   assert(ge);
   assert(gf);
 
-  ge->pl().delResEdg();
-  gf->pl().delResEdg();
+  state(ge).delResEdg();
+  state(gf).delResEdg();
 
-  _resEdgs[ge].erase(ce);
-  _resEdgs[gf].erase(ce);
+  delResEdg(ge, ce);
+  delResEdg(gf, ce);
 
-  if (_resEdgs[ge].size() == 0) {
-    if (!a->pl().isSettled() && unused(a)) openTurns(a);
-    if (!b->pl().isSettled() && unused(b)) openTurns(b);
+  if (numResEdgs(ge) == 0) {
+    if (!state(a).isSettled() && unused(a)) openTurns(a);
+    if (!state(b).isSettled() && unused(b)) openTurns(b);
   }
 
   // unblock diagonal edges crossing this edge
@@ -68,12 +68,12 @@ void OctiQuadTree::unSettleEdg(CombEdge* ce, GridNode* a, GridNode* b) {
     bb = getNode(a->pl().getX(), a->pl().getY() + len);
   }
 
-  if (aa && bb && _resEdgs[ge].size() == 0) {
+  if (aa && bb && numResEdgs(ge) == 0) {
     auto e = getNEdg(aa, bb);
     auto f = getNEdg(bb, aa);
     if (e && f) {
-      e->pl().unblock();
-      f->pl().unblock();
+      state(e).unblock();
+      state(f).unblock();
     }
   }
 }
@@ -122,8 +122,8 @@ void OctiQuadTree::settleEdg(GridNode* a, GridNode* b, CombEdge* e) {
     auto f = getNEdg(bb, aa);
 
     if (e && f) {
-      e->pl().block();
-      f->pl().block();
+      state(e).block();
+      state(f).block();
     }
   }
 }
@@ -131,7 +131,7 @@ void OctiQuadTree::settleEdg(GridNode* a, GridNode* b, CombEdge* e) {
 // _____________________________________________________________________________
 CrossEdgPairs OctiQuadTree::getCrossEdgPairs() const {
   CrossEdgPairs ret;
-  for (const GridNode* n : getNds()) {
+  for (const GridNode* n : getGrNds()) {
     if (!n->pl().isSink()) continue;
 
     auto nn = neigh(n, 3);
@@ -200,10 +200,10 @@ struct SplitFunc : util::geo::SplitFunc<const CombNode*, double> {
 
   QuadTree<const CombNode*, double> qt(maxDepth, sFunc, newBox);
 
-  _grid = Grid<GridNode*, Point, double>(
+  _grid = std::make_shared<Grid<GridNode*, Point, double>>(
       _cellSize, _cellSize, util::geo::pad(_bbox, _cellSize), false);
 
-  _ndIdx.resize(_grid.getXWidth() * _grid.getYHeight());
+  _ndIdx.resize(_grid->getXWidth() * _grid->getYHeight());
 
   // write nodes to quadtree
   for (auto cNd : _cg.getNds()) {
@@ -288,9 +288,14 @@ struct SplitFunc : util::geo::SplitFunc<const CombNode*, double> {
   }
 
   prunePorts();
+  initState();
   writeInitialCosts();
+  initCsr();
 }
 
+// _____________________________________________________________________________
+BaseGraph* OctiQuadTree::fork() const { return new OctiQuadTree(*this); }
+
 // _____________________________________________________________________________
 double OctiQuadTree::ndMovePen(const CombNode* cbNd,
                                const GridNode* grNd) const {
@@ -22,6 +22,7 @@ class OctiQuadTree : public OctiHananGraph {
   virtual CrossEdgPairs getCrossEdgPairs() const;
   virtual double ndMovePen(const CombNode* cbNd, const GridNode* grNd) const;
   virtual void init();
+  virtual BaseGraph* fork() const;
 };
 }  // namespace basegraph
 }  // namespace octi
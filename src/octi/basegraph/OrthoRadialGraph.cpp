@@ -25,7 +25,7 @@ using util::geo::DPoint;
 void OrthoRadialGraph::init() {
   // write nodes
   // TODO: we are only going from 1 because we have no center node
-  for (size_t y = 1; y < _grid.getYHeight() / 2; y++) {
+  for (size_t y = 1; y < _grid->getYHeight() / 2; y++) {
     for (size_t x = 0; x < _numBeams; x++) {
       writeNd(x, y);
     }
@@ -33,7 +33,7 @@ void OrthoRadialGraph::init() {
 
   // write grid edges
   for (size_t x = 0; x < _numBeams; x++) {
-    for (size_t y = 0; y < _grid.getYHeight() / 2; y++) {
+    for (size_t y = 0; y < _grid->getYHeight() / 2; y++) {
       GridNode* center = getNode(x, y);
       if (!center) continue;
 
@@ -51,7 +51,14 @@ void OrthoRadialGraph::init() {
     }
   }
 
+  initState();
   writeInitialCosts();
+  initCsr();
+}
+
+// _____________________________________________________________________________
+BaseGraph* OrthoRadialGraph::fork() const {
+  return new OrthoRadialGraph(*this);
 }
 
 // _____________________________________________________________________________
@@ -70,6 +77,9 @@ OrthoRadialGraph::getHeur(const std::set<GridNode*>& to) const {
   return new OrthoRadialGraphHeur(this, to);
 }
 
+// _____________________________________________________________________________
+bool OrthoRadialGraph::useHullHeur() const { return false; }
+
 // _____________________________________________________________________________
 GridEdge* OrthoRadialGraph::getNEdg(const GridNode* a,
                                     const GridNode* b) const {
@@ -91,14 +101,8 @@ GridEdge* OrthoRadialGraph::getNEdg(const GridNode* a,
   else
     return 0;
 
-  if (a->pl().getPort(dir) &&
-      b->pl().getPort((dir + maxDeg() / 2) % maxDeg())) {
-    return const_cast<GridEdge*>(
-        getEdg(a->pl().getPort(dir),
-               b->pl().getPort((dir + maxDeg() / 2) % maxDeg())));
-  }
-
-  return 0;
+  return portEdg(a->pl().getPort(dir),
+                 b->pl().getPort((dir + maxDeg() / 2) % maxDeg()));
 }
 
 // _____________________________________________________________________________
@@ -108,7 +112,7 @@ void OrthoRadialGraph::writeInitialCosts() {
   double c_0 = _c.p_45 - _c.p_135;
 
   for (size_t x = 0; x < _numBeams; x++) {
-    for (size_t y = 0; y < _grid.getYHeight() / 2; y++) {
+    for (size_t y = 0; y < _grid->getYHeight() / 2; y++) {
       auto n = getNode(x, y);
       if (!n) continue;
       for (size_t i = 0; i < maxDeg(); i++) {
@@ -128,10 +132,10 @@ void OrthoRadialGraph::writeInitialCosts() {
         // represent the map lengths exactly
         if (i % 2 == 0) {
           // vertical hops always have the same length
-          e->pl().setCost((_c.verticalPen));
+          state(e).setCost((_c.verticalPen));
         } else {
           // horizontal hops get bigger with higher y (= higher radius)
-          e->pl().setCost((_c.horizontalPen + c_0) * sX - c_0);
+          state(e).setCost((_c.horizontalPen + c_0) * sX - c_0);
         }
       }
     }
@@ -191,7 +195,7 @@ GridNode* OrthoRadialGraph::writeNd(size_t x, size_t y) {
   n->pl().setId(_nds.size());
   _nds.push_back(n);
   n->pl().setSink();
-  _grid.add(pos, n);
+  _grid->add(pos, n);
   n->pl().setXY(x, y);
   n->pl().setParent(n);
 
@@ -231,7 +235,7 @@ GridNode* OrthoRadialGraph::writeNd(size_t x, size_t y) {
 
       if (y == 1 && i == 2) pen = INF;
       if (y == 1 && j == 2) pen = INF;
-      if (y == _grid.getYHeight() / 2 && i == 0) pen = INF;
+      if (y == _grid->getYHeight() / 2 && i == 0) pen = INF;
 
       auto e = addEdg(n->pl().getPort(i), n->pl().getPort(j),
                             GridEdgePL(pen, true, false));
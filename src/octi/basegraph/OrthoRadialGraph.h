@@ -24,9 +24,11 @@ class OrthoRadialGraph : public GridGraph {
   }
 
   virtual void init();
+  virtual BaseGraph* fork() const;
   virtual GridEdge* getNEdg(const GridNode* a, const GridNode* b) const;
   virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
   getHeur(const std::set<GridNode*>& to) const;
+  virtual bool useHullHeur() const;
 
   virtual PolyLine<double> geomFromPath(
       const std::vector<std::pair<size_t, size_t>>& res) const;
@@ -28,84 +28,10 @@ int PseudoOrthoRadialGraph::multi(size_t y) const {
   return 1 << lg;
 }
 
-// _____________________________________________________________________________
-void PseudoOrthoRadialGraph::writeObstacleCost(
-    const util::geo::Polygon<double>& obst) {
-  for (size_t y = 1; y < _grid.getYHeight() / 2; y++) {
-    for (size_t x = 0; x < _numBeams * multi(y); x++) {
-      auto grNdA = getNode(x, y);
-
-      for (size_t i = 0; i < maxDeg(); i++) {
-        auto grNeigh = neigh(x, y, i);
-        if (!grNeigh) continue;
-        auto ge = getNEdg(grNdA, grNeigh);
-
-        if (intersects(
-                util::geo::LineSegment<double>(*ge->getFrom()->pl().getGeom(),
-                                               *ge->getTo()->pl().getGeom()),
-                obst) ||
-            contains(
-                util::geo::LineSegment<double>(*ge->getFrom()->pl().getGeom(),
-                                               *ge->getTo()->pl().getGeom()),
-                obst)) {
-          ge->pl().setCost(std::numeric_limits<double>::infinity());
-        }
-      }
-    }
-  }
-}
-
-// _____________________________________________________________________________
-void PseudoOrthoRadialGraph::writeGeoCoursePens(const CombEdge* ce,
-                                                GeoPensMap* target,
-                                                double pen) {
-  std::set<GridNode*> neighs;
-
-  DBox box;
-
-  std::vector<util::geo::DLine> geoms;
-
-  for (auto orE : ce->pl().getChilds()) {
-    box = util::geo::extendBox(*orE->pl().getGeom(), box);
-
-    // operate on simplified geometries
-    geoms.push_back(util::geo::simplify(*orE->pl().getGeom(), 5));
-  }
-
-  box = util::geo::pad(box, sqrt(SOFT_INF / pen) * getCellSize());
-  _grid.get(box, &neighs);
-
-  for (auto grNdA : neighs) {
-    for (size_t i = 0; i < maxDeg(); i++) {
-      auto grNeigh = neigh(grNdA->pl().getX(), grNdA->pl().getY(), i);
-      if (!grNeigh) continue;
-      auto ge = getNEdg(grNdA, grNeigh);
-
-      double d = std::numeric_limits<double>::infinity();
-
-      for (const auto& geom : geoms) {
-        double dLoc = fmax(
-            fmax(dist(geom, *ge->getFrom()->pl().getGeom()) / getCellSize(),
-                 dist(geom, util::geo::centroid(util::geo::MultiPoint<double>{
-                                *ge->getFrom()->pl().getGeom(),
-                                *ge->getFrom()->pl().getGeom()})) /
-                     getCellSize()),
-            dist(geom, *ge->getTo()->pl().getGeom()) / getCellSize());
-
-        if (dLoc < d) d = dLoc;
-      }
-
-      d *= pen * d;
-
-      if (d <= SOFT_INF) (*target)[ce][ge->pl().getId()] = d;
-    }
-  }
-}
-
 // _____________________________________________________________________________
 void PseudoOrthoRadialGraph::init() {
   // write nodes
-  for (size_t y = 1; y < _grid.getYHeight() / 2; y++) {
+  for (size_t y = 1; y < _grid->getYHeight() / 2; y++) {
     for (size_t x = 0; x < _numBeams * multi(y); x++) {
       writeNd(x, y);
     }
@@ -115,7 +41,7 @@ void PseudoOrthoRadialGraph::init() {
   writeNd(0, 0);
 
   // write grid edges
-  for (size_t y = 0; y < _grid.getYHeight() / 2; y++) {
+  for (size_t y = 0; y < _grid->getYHeight() / 2; y++) {
     size_t n = _numBeams * multi(y);
     if (y == 0) n = 1;
     for (size_t x = 0; x < n; x++) {
@@ -138,8 +64,15 @@ void PseudoOrthoRadialGraph::init() {
     }
   }
 
+  initState();
   writeInitialCosts();
   prunePorts();
+  initCsr();
+}
+
+// _____________________________________________________________________________
+BaseGraph* PseudoOrthoRadialGraph::fork() const {
+  return new PseudoOrthoRadialGraph(*this);
 }
 
 // _____________________________________________________________________________
@@ -257,14 +190,8 @@ GridEdge* PseudoOrthoRadialGraph::getNEdg(const GridNode* a,
     return 0;
   }
 
-  if (a->pl().getPort(dir) &&
-      b->pl().getPort((dir + maxDeg() / 2) % maxDeg())) {
-    return const_cast<GridEdge*>(
-        getEdg(a->pl().getPort(dir),
-               b->pl().getPort((dir + maxDeg() / 2) % maxDeg())));
-  }
-
-  return 0;
+  return portEdg(a->pl().getPort(dir),
+                 b->pl().getPort((dir + maxDeg() / 2) % maxDeg()));
 }
 
 // _____________________________________________________________________________
@@ -274,7 +201,7 @@ void PseudoOrthoRadialGraph::writeInitialCosts() {
 
   double c_0 = _c.p_45 - _c.p_135;
 
-  for (size_t y = 0; y < _grid.getYHeight() / 2; y++) {
+  for (size_t y = 0; y < _grid->getYHeight() / 2; y++) {
     size_t n = _numBeams * multi(y);
     if (y == 0) n = 1;
     double angStepLoc = 2.0 * M_PI / n;
@@ -301,12 +228,12 @@ void PseudoOrthoRadialGraph::writeInitialCosts() {
         // represent the map lengths exactly
         if (i % 2 == 0) {
           // vertical hops always have the same length
-          e->pl().setCost(_c.verticalPen);
-          assert(e->pl().cost() >= 0);
+          state(e).setCost(_c.verticalPen);
+          assert(state(e).cost() >= 0);
         } else {
           // horizontal hops get bigger with higher y (= higher radius)
-          e->pl().setCost((_c.horizontalPen + c_0) * sX - c_0);
-          assert(e->pl().cost() >= 0);
+          state(e).setCost((_c.horizontalPen + c_0) * sX - c_0);
+          assert(state(e).cost() >= 0);
         }
       }
     }
@@ -369,7 +296,7 @@ GridNode* PseudoOrthoRadialGraph::writeNd(size_t x, size_t y) {
 
   // we are using the raw position here, as grid cells do not reflect the
   // positions in the grid graph as in the octilinear case
-  _grid.add(pos, n);
+  _grid->add(pos, n);
   n->pl().setXY(x, y); n->pl().setParent(n);
 
   for (int i = 0; i < 4; i++) {
@@ -408,7 +335,7 @@ GridNode* PseudoOrthoRadialGraph::writeNd(size_t x, size_t y) {
 
       if (y == 1 && x % 2 && i == 2) pen = INF;
       if (y == 1 && x % 2 && j == 2) pen = INF;
-      if (y == _grid.getYHeight() / 2 && i == 0) pen = INF;
+      if (y == _grid->getYHeight() / 2 && i == 0) pen = INF;
 
       auto e = addEdg(n->pl().getPort(i), n->pl().getPort(j),
                       GridEdgePL(pen, true, false));
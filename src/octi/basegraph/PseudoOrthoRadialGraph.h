@@ -24,6 +24,7 @@ class PseudoOrthoRadialGraph : public GridGraph {
   }
 
   virtual void init();
+  virtual BaseGraph* fork() const;
   virtual GridEdge* getNEdg(const GridNode* a, const GridNode* b) const;
   virtual const util::graph::Dijkstra::HeurFunc<GridNodePL, GridEdgePL, float>*
   getHeur(const std::set<GridNode*>& to) const;
@@ -32,8 +33,6 @@ class PseudoOrthoRadialGraph : public GridGraph {
   virtual PolyLine<double> geomFromPath(
       const std::vector<std::pair<size_t, size_t>>& res) const;
   virtual double ndMovePen(const CombNode* cbNd, const GridNode* grNd) const;
-  virtual void writeGeoCoursePens(const CombEdge* ce, GeoPensMap* target,
-                                  double pen);
 
  protected:
   virtual void writeInitialCosts();
@@ -42,7 +41,6 @@ class PseudoOrthoRadialGraph : public GridGraph {
   virtual GridNode* getNode(size_t x, size_t y) const;
   virtual void getSettledAdjEdgs(GridNode* n, CombNode* origNd,
                                  CombEdge* outgoing[8]);
-  virtual void writeObstacleCost(const util::geo::Polygon<double>& obst);
 
  private:
   virtual int multi(size_t y) const;
@@ -62,7 +60,7 @@ struct PseudoOrthoRadialGraphHeur
       size_t i = 0;
       for (; i < g->maxDeg(); i++) {
         if (!n->pl().getPort(i)) continue;
-        float sinkCost = g->getEdg(n->pl().getPort(i), n)->pl().cost();
+        float sinkCost = g->state(g->getEdg(n->pl().getPort(i), n)).cost();
         if (sinkCost < cheapestSink) cheapestSink = sinkCost;
         auto neigh = g->neigh(n, i);
         if (neigh && to.find(neigh) == to.end()) {
@@ -73,7 +71,7 @@ struct PseudoOrthoRadialGraphHeur
       }
       for (size_t j = i; j < g->maxDeg(); j++) {
         if (!n->pl().getPort(j)) continue;
-        float sinkCost = g->getEdg(n->pl().getPort(j), n)->pl().cost();
+        float sinkCost = g->state(g->getEdg(n->pl().getPort(j), n)).cost();
         if (sinkCost < cheapestSink) cheapestSink = sinkCost;
       }
     }
@@ -30,12 +30,18 @@ class CombEdgePL : util::geograph::GeoEdgePL<double> {
   size_t getNumLines() const { return _maxLineNum; }
   void setNumLines(size_t numLines) { _maxLineNum = numLines; }
 
+  // dense id, assigned by CombGraph
+  size_t getId() const { return _id; }
+  void setId(size_t id) { _id = id; }
+
  private:
   std::vector<shared::linegraph::LineEdge*> _childs;
 
   size_t _maxLineNum;
 
   PolyLine<double> _geom;
+
+  size_t _id;
 };
 }
 }
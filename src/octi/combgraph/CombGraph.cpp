@@ -14,16 +14,39 @@ using shared::linegraph::LineNode;
 CombGraph::CombGraph(const LineGraph* g) : CombGraph(g, false) {}
 
 // _____________________________________________________________________________
-CombGraph::CombGraph(const LineGraph* g, bool collapse) : _bbox(g->getBBox()) {
+CombGraph::CombGraph(const LineGraph* g, bool collapse)
+    : _bbox(g->getBBox()), _numNdIds(0), _numEdgIds(0) {
   build(g);
   if (collapse) combineDeg2();
   writeEdgeOrdering();
   writeMaxLineNum();
+  writeIds();
 }
 
 // _____________________________________________________________________________
 const util::geo::DBox& CombGraph::getBBox() const { return _bbox; }
 
+// _____________________________________________________________________________
+size_t CombGraph::getNumNdIds() const { return _numNdIds; }
+
+// _____________________________________________________________________________
+size_t CombGraph::getNumEdgIds() const { return _numEdgIds; }
+
+// _____________________________________________________________________________
+void CombGraph::writeIds() {
+  _numNdIds = 0;
+  _numEdgIds = 0;
+
+  for (auto n : getNds()) n->pl().setId(_numNdIds++);
+
+  for (auto n : getNds()) {
+    for (auto e : n->getAdjList()) {
+      if (e->getFrom() != n) continue;
+      e->pl().setId(_numEdgIds++);
+    }
+  }
+}
+
 // _____________________________________________________________________________
 void CombGraph::build(const LineGraph* source) {
   auto nodes = source->getNds();
@@ -29,12 +29,18 @@ class CombGraph : public util::graph::UndirGraph<CombNodePL, CombEdgePL> {
 
   const util::geo::DBox& getBBox() const;
 
+  // node ids are in [0, getNumNdIds()), edge ids in [0, getNumEdgIds())
+  size_t getNumNdIds() const;
+  size_t getNumEdgIds() const;
+
  private:
   util::geo::Box<double> _bbox;
+  size_t _numNdIds, _numEdgIds;
   void build(const LineGraph* source);
   void combineDeg2();
   void writeEdgeOrdering();
   void writeMaxLineNum();
+  void writeIds();
 };
 
 }  // namespace combgraph
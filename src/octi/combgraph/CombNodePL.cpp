@@ -9,7 +9,7 @@ using octi::combgraph::CombNodePL;
 
 // _____________________________________________________________________________
 CombNodePL::CombNodePL(shared::linegraph::LineNode* parent)
-    : _parent(parent) {}
+    : _parent(parent), _id(0) {}
 
 // _____________________________________________________________________________
 const Point<double>* CombNodePL::getGeom() const {
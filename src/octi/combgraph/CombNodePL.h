@@ -19,7 +19,7 @@ namespace combgraph {
 
 class CombNodePL : util::geograph::GeoNodePL<double> {
  public:
-  CombNodePL(){};
+  CombNodePL() : _id(0){};
   CombNodePL(shared::linegraph::LineNode* parent);
 
   const Point<double>* getGeom() const;
@@ -32,10 +32,15 @@ class CombNodePL : util::geograph::GeoNodePL<double> {
   void setRouteNumber(size_t n);
   std::string toString() const;
 
+  // dense id, assigned by CombGraph
+  size_t getId() const { return _id; }
+  void setId(size_t id) { _id = id; }
+
  private:
   shared::linegraph::LineNode* _parent;
   size_t _routeNumber;
   combgraph::EdgeOrdering _ordering;
+  size_t _id;
 };
 }
 }
@@ -45,10 +45,14 @@ void Drawing::setBaseGraph(const BaseGraph* gg) { _gg = gg; }
 Score Drawing::fullScore() const {
   Score ret{0, 0, 0, 0, 0, 0, 0};
 
-  for (auto c : _ndReachCosts) ret.move += c.second;
-  for (auto c : _ndBndCosts) ret.bend += c.second;
-  for (auto c : _edgCosts) ret.hop += c.second;
-  for (auto c : _springCosts) ret.dense += c.second;
+  for (const auto& n : _nds) {
+    ret.move += n.reachCost;
+    ret.bend += n.bndCost;
+  }
+  for (const auto& e : _edgs) {
+    ret.hop += e.cost;
+    ret.dense += e.springCost;
+  }
   ret.full = _c + basegraph::SOFT_INF * violations();
   ret.violations = violations();
 
@@ -57,22 +61,34 @@ Score Drawing::fullScore() const {
 
 // _____________________________________________________________________________
 void Drawing::draw(CombEdge* ce, const GrEdgList& ges, bool rev) {
+  logUndo(ce);
+  logUndo(ce->getFrom());
+  logUndo(ce->getTo());
+
+  // create both node entries first, the references below stay valid then
+  get(ce->getFrom());
+  get(ce->getTo());
+  auto& frD = get(ce->getFrom());
+  auto& toD = get(ce->getTo());
+  auto& eD = get(ce);
+
   if (_c == std::numeric_limits<double>::infinity()) _c = 0;
-  if (_edgs.count(ce)) _edgs[ce].clear();
+  eD.path.clear();
 
   int l = 0;
 
   for (size_t i = 0; i < ges.size(); i++) {
     auto ge = ges[i];
 
+    frD.drawn = true;
+    toD.drawn = true;
+
     if (rev) {
-      _nds[ce->getFrom()] =
-          ges.front()->getTo()->pl().getParent()->pl().getId();
-      _nds[ce->getTo()] = ges.back()->getFrom()->pl().getParent()->pl().getId();
+      frD.grNd = ges.front()->getTo()->pl().getParent()->pl().getId();
+      toD.grNd = ges.back()->getFrom()->pl().getParent()->pl().getId();
     } else {
-      _nds[ce->getTo()] = ges.front()->getTo()->pl().getParent()->pl().getId();
-      _nds[ce->getFrom()] =
-          ges.back()->getFrom()->pl().getParent()->pl().getId();
+      toD.grNd = ges.front()->getTo()->pl().getParent()->pl().getId();
+      frD.grNd = ges.back()->getFrom()->pl().getParent()->pl().getId();
     }
 
     // there are three kinds of cost contained in a result:
@@ -88,37 +104,30 @@ void Drawing::draw(CombEdge* ce, const GrEdgList& ges, bool rev) {
     //  d) edge costs, which can also be safely removed if a settled edge is
     //     unsettled
 
-    double edgeCost = ge->pl().cost();
+    double edgeCost = _gg->state(ge).cost();
     if (edgeCost >= basegraph::SOFT_INF) {
       int vios = edgeCost / basegraph::SOFT_INF;
       edgeCost -= vios * basegraph::SOFT_INF;
-      _vios[ce]++;
+      eD.vios++;
       _violations++;
     }
 
     _c += edgeCost;
 
-    if (i == 0) {
-      if (!_ndReachCosts.count(rev ? ce->getFrom() : ce->getTo())) {
+    if (i == 0 || i == ges.size() - 1) {
+      auto& nD = (i == 0) == rev ? frD : toD;
+      if (!nD.hasReachCost) {
         // if the node was not settled before, this is the node move cost
-        _ndReachCosts[rev ? ce->getFrom() : ce->getTo()] = edgeCost;
-        _ndBndCosts[rev ? ce->getFrom() : ce->getTo()] = 0;
+        nD.hasReachCost = true;
+        nD.reachCost = edgeCost;
+        nD.bndCost = 0;
       } else {
         // otherwise it is the reach cost belonging to the edge
-        _ndBndCosts[rev ? ce->getFrom() : ce->getTo()] += edgeCost;
-      }
-    } else if (i == ges.size() - 1) {
-      if (!_ndReachCosts.count(rev ? ce->getTo() : ce->getFrom())) {
-        // if the node was not settled before, this is the node move cost
-        _ndReachCosts[rev ? ce->getTo() : ce->getFrom()] = edgeCost;
-        _ndBndCosts[rev ? ce->getTo() : ce->getFrom()] = 0;
-      } else {
-        // otherwise it is the reach cost belonging to the edge
-        _ndBndCosts[rev ? ce->getTo() : ce->getFrom()] += edgeCost;
+        nD.bndCost += edgeCost;
       }
     } else {
       if (!ge->pl().isSecondary()) l++;
-      _edgCosts[ce] += edgeCost;
+      eD.cost += edgeCost;
     }
 
     if (rev) {
@@ -126,12 +135,14 @@ void Drawing::draw(CombEdge* ce, const GrEdgList& ges, bool rev) {
                            ges[ges.size() - 1 - i]->getFrom());
 
       if (!e->pl().isSecondary()) {
-        _edgs[ce].push_back(
+        eD.drawn = true;
+        eD.path.push_back(
             {e->getFrom()->pl().getId(), e->getTo()->pl().getId()});
       }
     } else {
       if (!ges[i]->pl().isSecondary()) {
-        _edgs[ce].push_back(
+        eD.drawn = true;
+        eD.path.push_back(
             {ges[i]->getFrom()->pl().getId(), ges[i]->getTo()->pl().getId()});
 
         assert(_gg->getEdg(ges[i]->getFrom(), ges[i]->getTo()) == ges[i]);
@@ -160,13 +171,13 @@ void Drawing::draw(CombEdge* ce, const GrEdgList& ges, bool rev) {
   double pen = 0;
   if (F > 0) pen = E;
 
-  _springCosts[ce] = pen;
-  _c += _springCosts[ce];
+  eD.springCost = pen;
+  _c += eD.springCost;
 }
 
 // _____________________________________________________________________________
 const GridNode* Drawing::getGrNd(const CombNode* cn) {
-  return _gg->getGrNdById(_nds[cn]);
+  return _gg->getGrNdById(get(cn).grNd);
 }
 
 // _____________________________________________________________________________
@@ -187,20 +198,21 @@ void Drawing::getLineGraph(LineGraph* target) const {
 
   // settle grid nodes, _nds contains a mapping of input comb edges to
   // grid node ids
-  for (auto ndpair : _nds) {
-    auto combNd = ndpair.first;
+  for (const auto& ndD : _nds) {
+    if (!ndD.drawn) continue;
+    auto combNd = ndD.nd;
     for (auto f : combNd->getAdjListOut()) {
       // go over each adjacent edge's image path and add nodes to the target
       // graph for the image's end and start node
 
       if (f->getFrom() != combNd) continue;
-      if (_edgs.find(f) == _edgs.end()) {
+      if (!drawn(f)) {
         LOGTO(WARN, std::cerr) << "Edge " << f << " was not drawn, skipping...";
         continue;
       }
 
       // the image path...
-      auto pth = _edgs.find(f)->second;
+      const auto& pth = find(f)->path;
       assert(_gg->getGrEdgById(pth.back()));
       assert(_gg->getGrEdgById(pth.front()));
       // ... and it's from and to grid nodes. We can be sure that that
@@ -231,13 +243,14 @@ void Drawing::getLineGraph(LineGraph* target) const {
   }
 
   // build segments per path
-  for (auto ndpair : _nds) {
-    auto n = ndpair.first;
+  for (const auto& ndD : _nds) {
+    if (!ndD.drawn) continue;
+    auto n = ndD.nd;
     for (auto f : n->getAdjListOut()) {
       if (f->getFrom() != n) continue;
-      if (_edgs.find(f) == _edgs.end()) continue;  // edge was not drawn
+      if (!drawn(f)) continue;  // edge was not drawn
 
-      auto path = _edgs.find(f)->second;
+      const auto& path = find(f)->path;
 
       std::set<CombEdge*> curResEdgs;
 
@@ -302,11 +315,12 @@ void Drawing::getLineGraph(LineGraph* target) const {
   for (auto& segment : pathSegs) segment.geom = _gg->geomFromPath(segment.path);
 
   // add nodes to segments
-  for (auto ndpair : _nds) {
-    auto n = ndpair.first;
+  for (const auto& ndD : _nds) {
+    if (!ndD.drawn) continue;
+    auto n = ndD.nd;
     for (auto f : n->getAdjListOut()) {
       if (f->getFrom() != n) continue;
-      if (_edgs.find(f) == _edgs.end()) continue;
+      if (!drawn(f)) continue;
 
       double dTot = 0;
       for (const auto& seg : cEdgSeg[f])
@@ -473,27 +487,23 @@ void Drawing::crumble() {
   _violations = 0;
   _nds.clear();
   _edgs.clear();
-  _ndReachCosts.clear();
-  _ndBndCosts.clear();
-  _edgCosts.clear();
-  _vios.clear();
-  _springCosts.clear();
 }
 
 // _____________________________________________________________________________
 double Drawing::recalcBends(const CombNode* nd) {
   double c = 0;
 
-  if (_nds.count(nd) == 0) return 0;
-  auto gnd = _gg->getGrNdById(_nds.find(nd)->second);
+  auto ndD = find(nd);
+  if (!ndD || !ndD->drawn) return 0;
+  auto gnd = _gg->getGrNdById(ndD->grNd);
 
   // TODO: implement this better
 
   for (auto e : nd->getAdjList()) {
-    if (_edgs.count(e) == 0) {
+    if (!drawn(e)) {
       continue;  // dont count edge that havent been drawn
     }
-    auto ge = _edgs.find(e)->second;
+    const auto& ge = find(e)->path;
 
     size_t dirA = 0;
     for (; dirA < _gg->maxDeg(); dirA++) {
@@ -510,10 +520,10 @@ double Drawing::recalcBends(const CombNode* nd) {
     for (auto lo : e->pl().getChilds().front()->pl().getLines()) {
       for (auto f : nd->getAdjList()) {
         if (e == f) continue;
-        if (_edgs.count(f) == 0) {
+        if (!drawn(f)) {
           continue;  // dont count edges that havent been drawn
         }
-        auto gf = _edgs.find(f)->second;
+        const auto& gf = find(f)->path;
 
         if (f->pl().getChilds().front()->pl().hasLine(lo.line)) {
           size_t dirB = 0;
@@ -542,50 +552,102 @@ double Drawing::recalcBends(const CombNode* nd) {
 }
 
 // _____________________________________________________________________________
-bool Drawing::drawn(const CombEdge* ce) const { return _edgs.count(ce); }
+bool Drawing::drawn(const CombEdge* ce) const {
+  auto eD = find(ce);
+  return eD && eD->drawn;
+}
+
+// _____________________________________________________________________________
+std::map<const CombEdge*, GrPath> Drawing::getEdgPaths() const {
+  std::map<const CombEdge*, GrPath> ret;
+  for (const auto& eD : _edgs) {
+    if (eD.drawn) ret[eD.e] = eD.path;
+  }
+  return ret;
+}
+
+// _____________________________________________________________________________
+Drawing::NdDrawing& Drawing::get(const CombNode* nd) {
+  size_t id = nd->pl().getId();
+  if (id >= _nds.size()) _nds.resize(id + 1);
+  _nds[id].nd = nd;
+  return _nds[id];
+}
 
 // _____________________________________________________________________________
-const std::map<const CombEdge*, GrPath>& Drawing::getEdgPaths() const {
-  return _edgs;
+Drawing::EdgDrawing& Drawing::get(const CombEdge* e) {
+  size_t id = e->pl().getId();
+  if (id >= _edgs.size()) _edgs.resize(id + 1);
+  _edgs[id].e = e;
+  return _edgs[id];
+}
+
+// _____________________________________________________________________________
+const Drawing::NdDrawing* Drawing::find(const CombNode* nd) const {
+  size_t id = nd->pl().getId();
+  if (id >= _nds.size()) return 0;
+  return &_nds[id];
+}
+
+// _____________________________________________________________________________
+const Drawing::EdgDrawing* Drawing::find(const CombEdge* e) const {
+  size_t id = e->pl().getId();
+  if (id >= _edgs.size()) return 0;
+  return &_edgs[id];
 }
 
 // _____________________________________________________________________________
 void Drawing::erase(CombEdge* ce) {
-  _edgs.erase(ce);
-  _c -= _edgCosts[ce];
-  _edgCosts.erase(ce);
+  logUndo(ce);
+  logUndo(ce->getFrom());
+  logUndo(ce->getTo());
+
+  // create both node entries first, the references below stay valid then
+  get(ce->getFrom());
+  get(ce->getTo());
+  auto& frD = get(ce->getFrom());
+  auto& toD = get(ce->getTo());
+  auto& eD = get(ce);
+
+  eD.drawn = false;
+  eD.path.clear();
+  _c -= eD.cost;
+  eD.cost = 0;
 
-  _c -= _springCosts[ce];
-  _springCosts.erase(ce);
+  _c -= eD.springCost;
+  eD.springCost = 0;
 
-  _c -= _ndBndCosts[ce->getFrom()];
-  _c -= _ndBndCosts[ce->getTo()];
+  _c -= frD.bndCost;
+  _c -= toD.bndCost;
 
   // update bend costs
-  _ndBndCosts[ce->getFrom()] = recalcBends(ce->getFrom());
-  _ndBndCosts[ce->getTo()] = recalcBends(ce->getTo());
+  frD.bndCost = recalcBends(ce->getFrom());
+  toD.bndCost = recalcBends(ce->getTo());
 
-  _c += _ndBndCosts[ce->getTo()];
-  _c += _ndBndCosts[ce->getFrom()];
+  _c += toD.bndCost;
+  _c += frD.bndCost;
 
-  _violations -= _vios[ce];
-  _vios.erase(ce);
+  _violations -= eD.vios;
+  eD.vios = 0;
 }
 
 // _____________________________________________________________________________
 void Drawing::erase(CombNode* cn) {
-  _nds.erase(cn);
-  _c -= _ndReachCosts[cn];
-  _c -= _ndBndCosts[cn];
-  _ndReachCosts.erase(cn);
-  _ndBndCosts.erase(cn);
+  logUndo(cn);
+
+  auto& nD = get(cn);
+  nD.drawn = false;
+  _c -= nD.reachCost;
+  _c -= nD.bndCost;
+  nD.hasReachCost = false;
+  nD.reachCost = 0;
+  nD.bndCost = 0;
 }
 
 // _____________________________________________________________________________
 void Drawing::eraseFromGrid(const CombEdge* ce, BaseGraph* gg) {
-  auto it = _edgs.find(ce);
-  if (it == _edgs.end()) return;
-  const auto& es = it->second;
+  if (!drawn(ce)) return;
+  const auto& es = find(ce)->path;
   for (auto eid : es) {
     auto e = gg->getGrEdgById(eid);
     // TODO: remove const cast
@@ -596,9 +658,8 @@ void Drawing::eraseFromGrid(const CombEdge* ce, BaseGraph* gg) {
 
 // _____________________________________________________________________________
 void Drawing::applyToGrid(const CombEdge* ce, BaseGraph* gg) {
-  auto it = _edgs.find(ce);
-  if (it == _edgs.end()) return;
-  const auto& es = it->second;
+  if (!drawn(ce)) return;
+  const auto& es = find(ce)->path;
 
   for (auto eid : es) {
     auto e = gg->getGrEdgById(eid);
@@ -614,36 +675,96 @@ void Drawing::eraseFromGrid(const CombNode* nd, BaseGraph* gg) {
 
 // _____________________________________________________________________________
 void Drawing::applyToGrid(const CombNode* nd, BaseGraph* gg) {
-  gg->settleNd(const_cast<GridNode*>(gg->getGrNdById(_nds[nd])),
+  gg->settleNd(const_cast<GridNode*>(gg->getGrNdById(get(nd).grNd)),
                const_cast<CombNode*>(nd));
 }
 
 // _____________________________________________________________________________
 void Drawing::eraseFromGrid(BaseGraph* gg) {
-  for (auto e : _edgs) eraseFromGrid(e.first, gg);
-  for (auto nd : _nds) eraseFromGrid(nd.first, gg);
+  for (const auto& eD : _edgs) {
+    if (eD.drawn) eraseFromGrid(eD.e, gg);
+  }
+  for (const auto& nD : _nds) {
+    if (nD.drawn) eraseFromGrid(nD.nd, gg);
+  }
 }
 
 // _____________________________________________________________________________
 void Drawing::applyToGrid(BaseGraph* gg) {
-  for (auto nd : _nds) applyToGrid(nd.first, gg);
-  for (auto e : _edgs) applyToGrid(e.first, gg);
+  for (const auto& nD : _nds) {
+    if (nD.drawn) applyToGrid(nD.nd, gg);
+  }
+  for (const auto& eD : _edgs) {
+    if (eD.drawn) applyToGrid(eD.e, gg);
+  }
 }
 
 // _____________________________________________________________________________
 double Drawing::getEdgCost(const CombEdge* e) const {
-  if (_edgCosts.count(e)) return _edgCosts.find(e)->second;
-  return 0;
+  auto eD = find(e);
+  return eD ? eD->cost : 0;
 }
 
 // _____________________________________________________________________________
 double Drawing::getNdBndCost(const CombNode* n) const {
-  if (_ndBndCosts.count(n)) return _ndBndCosts.find(n)->second;
-  return 0;
+  auto nD = find(n);
+  return nD ? nD->bndCost : 0;
 }
 
 // _____________________________________________________________________________
 double Drawing::getNdReachCost(const CombNode* n) const {
-  if (_ndReachCosts.count(n)) return _ndReachCosts.find(n)->second;
-  return 0;
+  auto nD = find(n);
+  return nD ? nD->reachCost : 0;
+}
+
+// _____________________________________________________________________________
+void Drawing::begin() {
+  _undo.savePoints.push_back(
+      {_undo.nds.size(), _undo.edgs.size(), _c, _violations});
+}
+
+// _____________________________________________________________________________
+void Drawing::commit() {
+  assert(_undo.savePoints.size());
+  _undo.savePoints.pop_back();
+
+  if (_undo.savePoints.empty()) {
+    _undo.nds.clear();
+    _undo.edgs.clear();
+  }
+}
+
+// _____________________________________________________________________________
+void Drawing::rollback() {
+  assert(_undo.savePoints.size());
+  const auto sp = _undo.savePoints.back();
+  _undo.savePoints.pop_back();
+
+  // restore in reverse order, so that the oldest value of an entry wins
+  while (_undo.edgs.size() > sp.edgs) {
+    auto& u = _undo.edgs.back();
+    _edgs[u.id] = std::move(u.d);
+    _undo.edgs.pop_back();
+  }
+
+  while (_undo.nds.size() > sp.nds) {
+    auto& u = _undo.nds.back();
+    _nds[u.id] = std::move(u.d);
+    _undo.nds.pop_back();
+  }
+
+  _c = sp.c;
+  _violations = sp.violations;
+}
+
+// _____________________________________________________________________________
+void Drawing::logUndo(const CombNode* nd) {
+  if (_undo.savePoints.empty()) return;
+  _undo.nds.push_back({nd->pl().getId(), get(nd)});
+}
+
+// _____________________________________________________________________________
+void Drawing::logUndo(const CombEdge* e) {
+  if (_undo.savePoints.empty()) return;
+  _undo.edgs.push_back({e->pl().getId(), get(e)});
 }
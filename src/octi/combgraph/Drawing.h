@@ -2,6 +2,7 @@
 #define OCTI_COMBGRAPH_DRAWING_H_
 
 #include <map>
+#include <vector>
 #include "octi/basegraph/BaseGraph.h"
 #include "octi/combgraph/CombGraph.h"
 #include "util/graph/Dijkstra.h"
@@ -84,6 +85,14 @@ class Drawing {
   Score fullScore() const;
   void crumble();
 
+  // Transactions. Changes made by draw() and erase() after begin() are
+  // recorded in an undo log and reverted by rollback(). Transactions may be
+  // nested, rollback() and commit() always refer to the innermost one. The
+  // log is never copied, a copy of a drawing is not in a transaction.
+  void begin();
+  void commit();
+  void rollback();
+
   void draw(CombEdge* ce, const GrEdgList& ge, bool rev);
   void erase(CombEdge* ce);
   void erase(CombNode* ce);
@@ -108,23 +117,85 @@ class Drawing {
 
   void setBaseGraph(const BaseGraph* gg);
 
-  const std::map<const CombEdge*, GrPath>& getEdgPaths() const;
+  std::map<const CombEdge*, GrPath> getEdgPaths() const;
 
  private:
-  std::map<const CombNode*, size_t> _nds;
-  std::map<const CombEdge*, GrPath> _edgs;
-
-  std::map<const CombNode*, double> _ndReachCosts;
-  std::map<const CombNode*, double> _ndBndCosts;
-  std::map<const CombEdge*, double> _edgCosts;
-  std::map<const CombEdge*, int> _vios;
-  std::map<const CombEdge*, double> _springCosts;
+  // drawing state of a single comb node, indexed by the node id
+  struct NdDrawing {
+    NdDrawing()
+        : nd(0),
+          drawn(false),
+          grNd(0),
+          hasReachCost(false),
+          reachCost(0),
+          bndCost(0) {}
+    const CombNode* nd;
+    bool drawn;
+    size_t grNd;
+    bool hasReachCost;
+    double reachCost, bndCost;
+  };
+
+  // drawing state of a single comb edge, indexed by the edge id
+  struct EdgDrawing {
+    EdgDrawing() : e(0), drawn(false), cost(0), vios(0), springCost(0) {}
+    const CombEdge* e;
+    bool drawn;
+    GrPath path;
+    double cost;
+    int vios;
+    double springCost;
+  };
+
+  std::vector<NdDrawing> _nds;
+  std::vector<EdgDrawing> _edgs;
+
   double _c;
   const BaseGraph* _gg;
 
   size_t _violations;
 
+  struct NdUndo {
+    size_t id;
+    NdDrawing d;
+  };
+
+  struct EdgUndo {
+    size_t id;
+    EdgDrawing d;
+  };
+
+  struct SavePoint {
+    size_t nds, edgs;
+    double c;
+    size_t violations;
+  };
+
+  struct UndoLog {
+    UndoLog() {}
+    UndoLog(const UndoLog&) {}
+    UndoLog& operator=(const UndoLog&) { return *this; }
+
+    std::vector<NdUndo> nds;
+    std::vector<EdgUndo> edgs;
+    std::vector<SavePoint> savePoints;
+  };
+
+  UndoLog _undo;
+
+  // the entries grow on demand, a returned reference is only valid until
+  // the next call with an id not seen before
+  NdDrawing& get(const CombNode* nd);
+  EdgDrawing& get(const CombEdge* e);
+
+  // 0 if the entry does not exist yet
+  const NdDrawing* find(const CombNode* nd) const;
+  const EdgDrawing* find(const CombEdge* e) const;
+
   double recalcBends(const CombNode* nd);
+
+  void logUndo(const CombNode* nd);
+  void logUndo(const CombEdge* e);
 };
 }  // namespace combgraph
 }  // namespace octi
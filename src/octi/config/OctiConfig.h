@@ -5,12 +5,14 @@
 #ifndef OCTI_CONFIG_OCTICONFIG_H_
 #define OCTI_CONFIG_OCTICONFIG_H_
 
+#include <memory>
 #include <string>
 #include "octi/basegraph/BaseGraph.h"
 #include "octi/basegraph/GridGraph.h"
 #include "util/geo/Geo.h"
 #include "3rdparty/json.hpp"
 #include "shared/config/JsonConfigHelper.h"
+#include "shared/linegraph/LineGraph.h"
 #include "util/log/Log.h"
 
 using octi::basegraph::BaseGraphType;
@@ -34,6 +36,7 @@ struct Config {
   double borderRad = 45;
 
   std::string printMode = "linegraph";
+  // heur, tempering, multilevel or ilp
   std::string optMode = "heur";
   std::string ilpPath;
   bool fromDot = false;
@@ -50,18 +53,45 @@ struct Config {
   bool skipOnError = false;
   bool retryOnError = false;
 
+  // number of grid sizes tried at once if retryOnError is set
+  size_t retryConcurrency = 1;
+
   double maxGrDist = 3;
 
   int heurLocSearchIters = 100;
 
+  // number of worker threads of the heuristic, 0 for one per core
+  size_t numThreads = 1;
+
   size_t abortAfter = -1;
 
+  // wall time budget of a whole run in ms, split across the components by
+  // their size. Negative for no limit.
+  double timeLimit = -1;
+
+  // coarsening of the first grid in the multilevel mode
+  size_t multilevelFactor = 3;
+
   size_t hananIters = 1;
+
+  // width of the corridor around the input for corridoroctilinear, in cells
+  size_t corridorCells = 5;
+
+  // landmarks for the ALT routing heuristic, 0 to disable
+  size_t landmarks = 0;
   bool writeStats = false;
 
   OrderMethod orderMethod;
 
   std::string obstaclePath;
+
+  // octilinear drawing of an earlier version of the input, the parts of the
+  // input which did not change keep their positions from it
+  std::string seedPath;
+  std::shared_ptr<const shared::linegraph::LineGraph> seed;
+
+  // binary copy of the input graph, reused on later runs with the same input
+  std::string graphCachePath;
   std::vector<util::geo::DPolygon> obstacles;
 
   octi::basegraph::BaseGraphType baseGraphType;
@@ -73,19 +103,27 @@ struct Config {
 inline void jsonToConfig(const nlohmann::json& jsonObj, Config* cfg) {
   using shared::config::assignIfContains;
   using shared::config::assignIfContainsBool;
+  using shared::config::assignIfContainsCount;
 
   assignIfContains<int>(jsonObj, "abortAfter", [&](int v){ cfg->abortAfter = v; });
   assignIfContainsBool(jsonObj, "fromDot", [&](bool v){ cfg->fromDot = v; });
   assignIfContains<std::string>(jsonObj, "optimMode", [&](const std::string& v){ cfg->optMode = v; });
   assignIfContains<int>(jsonObj, "ilpNumThreads", [&](int v){ cfg->ilpNumThreads = v; });
-  assignIfContains<int>(jsonObj, "hananIters", [&](int v){ cfg->hananIters = v; });
+  assignIfContainsCount(jsonObj, "hananIters", [&](size_t v){ cfg->hananIters = v; });
+  assignIfContainsCount(jsonObj, "corridorCells", [&](size_t v){ cfg->corridorCells = v; });
+  assignIfContainsCount(jsonObj, "landmarks", [&](size_t v){ cfg->landmarks = v; });
   assignIfContains<int>(jsonObj, "heurLocSearchIters", [&](int v){ cfg->heurLocSearchIters = v; });
+  assignIfContainsCount(jsonObj, "numThreads", [&](size_t v){ cfg->numThreads = v; });
+  assignIfContainsCount(jsonObj, "multilevelFactor", [&](size_t v){ cfg->multilevelFactor = v; });
   assignIfContains<double>(jsonObj, "ilpCacheThreshold", [&](double v){ cfg->ilpCacheThreshold = v; });
   assignIfContains<int>(jsonObj, "ilpTimeLimit", [&](int v){ cfg->ilpTimeLimit = v; });
+  assignIfContains<double>(jsonObj, "timeLimit", [&](double v){ cfg->timeLimit = v; });
   assignIfContains<std::string>(jsonObj, "ilpCacheDir", [&](const std::string& v){ cfg->ilpCacheDir = v; });
   assignIfContains<std::string>(jsonObj, "ilpSolver", [&](const std::string& v){ cfg->ilpSolver = v; });
   assignIfContainsBool(jsonObj, "writeStats", [&](bool v){ cfg->writeStats = v; });
   assignIfContains<std::string>(jsonObj, "obstaclePath", [&](const std::string& v){ cfg->obstaclePath = v; });
+  assignIfContains<std::string>(jsonObj, "seedPath", [&](const std::string& v){ cfg->seedPath = v; });
+  assignIfContains<std::string>(jsonObj, "graphCache", [&](const std::string& v){ cfg->graphCachePath = v; });
   assignIfContainsBool(jsonObj, "deg2Heur", [&](bool v){ cfg->deg2Heur = v; });
   assignIfContains<double>(jsonObj, "enfGeoPen", [&](double v){ cfg->enfGeoPen = v; });
   assignIfContains<double>(jsonObj, "maxGrDist", [&](double v){ cfg->maxGrDist = v; });
@@ -123,6 +161,8 @@ inline void jsonToConfig(const nlohmann::json& jsonObj, Config* cfg) {
       cfg->baseGraphType = octi::basegraph::BaseGraphType::HEXGRID;
     } else if (baseGraphStr == "chulloctilinear") {
       cfg->baseGraphType = octi::basegraph::BaseGraphType::CONVEXHULLOCTIGRID;
+    } else if (baseGraphStr == "corridoroctilinear") {
+      cfg->baseGraphType = octi::basegraph::BaseGraphType::OCTICORRIDORGRID;
     } else if (baseGraphStr == "pseudoorthoradial") {
       cfg->baseGraphType = octi::basegraph::BaseGraphType::PSEUDOORTHORADIAL;
     } else if (baseGraphStr == "quadtree") {
@@ -150,6 +190,7 @@ inline void jsonToConfig(const nlohmann::json& jsonObj, Config* cfg) {
 
   if (jsonObj.contains("skipOnError")) cfg->skipOnError = jsonObj["skipOnError"].get<bool>();
   if (jsonObj.contains("retryOnError")) cfg->retryOnError = jsonObj["retryOnError"].get<bool>();
+  if (jsonObj.contains("retryConcurrency")) cfg->retryConcurrency = jsonObj["retryConcurrency"].get<size_t>();
   if (jsonObj.contains("gridSize")) cfg->gridSize = jsonObj["gridSize"].get<std::string>();
 }
 
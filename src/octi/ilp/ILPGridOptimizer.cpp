@@ -33,11 +33,11 @@ ILPStats ILPGridOptimizer::optimize(BaseGraph* gg, const CombGraph& cg,
   StarterSol sol = extractFeasibleSol(d, gg, cg, maxGrDist);
   gg->reset();
 
-  for (auto nd : gg->getNds()) {
+  for (auto nd : gg->getGrNds()) {
     // if we presolve, some edges may be blocked
     for (auto e : nd->getAdjList()) {
-      e->pl().open();
-      e->pl().unblock();
+      gg->state(e).open();
+      gg->state(e).unblock();
     }
     if (!nd->pl().isSink()) continue;
     gg->openTurns(nd);
@@ -116,7 +116,7 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
     oneAssignment << "oneass(" << nd << ")";
     int rowStat = lp->addRow(oneAssignment.str(), 1, shared::optim::FIX);
 
-    for (const GridNode* n : gg->getNds()) {
+    for (const GridNode* n : gg->getGrNds()) {
       if (!n->pl().isSink()) continue;
 
       // don't use nodes as candidates which cannot hold the comb node due to
@@ -151,10 +151,10 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
   for (auto nd : cg.getNds()) {
     for (auto edg : nd->getAdjList()) {
       if (edg->getFrom() != nd) continue;
-      for (const GridNode* n : gg->getNds()) {
+      for (const GridNode* n : gg->getGrNds()) {
         for (const GridEdge* e : n->getAdjList()) {
           if (e->getFrom() != n) continue;
-          if (e->pl().cost() >= basegraph::SOFT_INF) {
+          if (gg->state(e).cost() >= basegraph::SOFT_INF) {
             // skip infinite edges, we cannot use them.
             // this also skips sink edges of nodes not used as
             // candidates
@@ -175,16 +175,13 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
 
           double coef;
           if (geoPensMap && !e->pl().isSecondary()) {
-            // add geo pen
-            auto thisMap = geoPensMap->find(edg)->second;
-            auto i = thisMap.find(e->pl().getId());
-            if (i != thisMap.end()) coef = e->pl().cost() + i->second;
-
-            // if no geopen was present for grid edge, we assume SOFT_INF
-            // penalty
-            coef = e->pl().cost() + octi::basegraph::SOFT_INF;
+            // add geo pen, if no geopen was present for grid edge, we assume
+            // SOFT_INF penalty
+            coef = gg->state(e).cost() +
+                   geoPensMap->find(edg)->second.get(
+                       e->pl().getId(), octi::basegraph::SOFT_INF);
           } else {
-            coef = e->pl().cost();
+            coef = gg->state(e).cost();
           }
           lp->addCol(edgeVarName, shared::optim::BIN, coef);
         }
@@ -196,7 +193,7 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
 
   // an edge can only be used a single time
   std::set<const GridEdge*> proced;
-  for (const GridNode* n : gg->getNds()) {
+  for (const GridNode* n : gg->getGrNds()) {
     for (const GridEdge* e : n->getAdjList()) {
       if (e->pl().isSecondary()) continue;
       if (proced.count(e)) continue;
@@ -212,7 +209,7 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
       for (auto nd : cg.getNds()) {
         for (auto edg : nd->getAdjList()) {
           if (edg->getFrom() != nd) continue;
-          if (e->pl().cost() >= basegraph::SOFT_INF) continue;
+          if (gg->state(e).cost() >= basegraph::SOFT_INF) continue;
 
           auto eVarName = getEdgUseVar(e, edg);
           auto fVarName = getEdgUseVar(f, edg);
@@ -228,8 +225,8 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
 
   // for every node, the number of outgoing and incoming used edges must be
   // the same, except for the start and end node
-  for (const GridNode* n : gg->getNds()) {
-    if (nonInfDeg(n) == 0) continue;
+  for (const GridNode* n : gg->getGrNds()) {
+    if (nonInfDeg(gg, n) == 0) continue;
 
     for (auto nd : cg.getNds()) {
       for (auto edg : nd->getAdjList()) {
@@ -294,7 +291,7 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
   // node
   // THIS RULE IS REDUNDANT AND IMPLICITELY ENFORCED BY OTHER RULES,
   // BUT SEEMS TO LEAD TO FASTER SOLUTION TIMES
-  for (GridNode* n : gg->getNds()) {
+  for (GridNode* n : gg->getGrNds()) {
     if (!n->pl().isSink()) continue;
 
     for (auto nd : cg.getNds()) {
@@ -340,7 +337,7 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
 
   // a grid node can either be an activated sink, or a single pass through
   // edge is used
-  for (GridNode* n : gg->getNds()) {
+  for (GridNode* n : gg->getGrNds()) {
     if (!n->pl().isSink()) continue;
 
     std::stringstream constName;
@@ -427,7 +424,7 @@ ILPSolver* ILPGridOptimizer::createProblem(BaseGraph* gg, const CombGraph& cg,
 
       lp->addColToRow(row, col, -1);
 
-      for (GridNode* n : gg->getNds()) {
+      for (GridNode* n : gg->getGrNds()) {
         if (!n->pl().isSink()) continue;
 
         // check if this grid node is used as a candidate for comb node
@@ -647,7 +644,7 @@ void ILPGridOptimizer::extractSolution(ILPSolver* lp, BaseGraph* gg,
   std::map<const CombEdge*, std::set<const GridEdge*>> gridEdgs;
 
   // write solution to grid graph
-  for (GridNode* n : gg->getNds()) {
+  for (GridNode* n : gg->getGrNds()) {
     for (GridEdge* e : n->getAdjList()) {
       if (e->getFrom() != n) continue;
 
@@ -669,7 +666,7 @@ void ILPGridOptimizer::extractSolution(ILPSolver* lp, BaseGraph* gg,
     }
   }
 
-  for (GridNode* n : gg->getNds()) {
+  for (GridNode* n : gg->getGrNds()) {
     if (!n->pl().isSink()) continue;
     for (auto nd : cg.getNds()) {
       auto varName = getStatPosVar(n, nd);
@@ -734,10 +731,11 @@ void ILPGridOptimizer::extractSolution(ILPSolver* lp, BaseGraph* gg,
 }
 
 // _____________________________________________________________________________
-size_t ILPGridOptimizer::nonInfDeg(const GridNode* g) const {
+size_t ILPGridOptimizer::nonInfDeg(const BaseGraph* gg,
+                                   const GridNode* g) const {
   size_t ret = 0;
   for (auto e : g->getAdjList()) {
-    if (e->pl().cost() < basegraph::SOFT_INF) ret++;
+    if (gg->state(e).cost() < basegraph::SOFT_INF) ret++;
   }
 
   return ret;
@@ -753,7 +751,7 @@ StarterSol ILPGridOptimizer::extractFeasibleSol(Drawing* d, BaseGraph* gg,
     if (nd->getDeg() == 0) continue;
     auto settled = gg->getSettled(nd);
 
-    for (auto gnd : gg->getNds()) {
+    for (auto gnd : gg->getGrNds()) {
       if (!gnd->pl().isSink()) continue;
       double gridD = dist(*nd->pl().getGeom(), *gnd->pl().getGeom());
 
@@ -796,7 +794,7 @@ StarterSol ILPGridOptimizer::extractFeasibleSol(Drawing* d, BaseGraph* gg,
   }
 
   // init edge use vars to 0
-  for (auto grNd : gg->getNds()) {
+  for (auto grNd : gg->getGrNds()) {
     for (auto grEdg : grNd->getAdjListOut()) {
       if (grEdg->pl().isSecondary()) continue;
 
@@ -71,7 +71,7 @@ class ILPGridOptimizer {
                                                const CombGraph& cg,
                                                double maxGrDist) const;
 
-  size_t nonInfDeg(const GridNode* g) const;
+  size_t nonInfDeg(const BaseGraph* gg, const GridNode* g) const;
 };
 }  // namespace ilp
 }  // namespace octi
@@ -33,6 +33,21 @@ inline void assignIfContains(const nlohmann::json& j, const std::string& key, Se
   }
 }
 
+// Assign a non-negative count given as an integer; exits on a negative value,
+// which would otherwise wrap around to a huge size_t.
+template <typename Setter>
+inline void assignIfContainsCount(const nlohmann::json& j, const std::string& key, Setter setter) {
+  if (j.contains(key)) {
+    int v;
+    try { v = j.at(key).get<int>(); } catch (...) { return; }
+    if (v < 0) {
+      std::cerr << key << " must not be negative, got " << v << std::endl;
+      exit(1);
+    }
+    setter(static_cast<size_t>(v));
+  }
+}
+
 // Convenience for boolean flags where presence toggles a field.
 template <typename Setter>
 inline void assignIfContainsBool(const nlohmann::json& j, const std::string& key, Setter setter) {
@@ -0,0 +1,160 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#include <stdexcept>
+
+#include "shared/linegraph/GeoJsonSaxHandler.h"
+
+using shared::linegraph::GeoJsonSaxHandler;
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::null() {
+  if (_target != NONE) addVal(nlohmann::json());
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::boolean(bool val) {
+  if (_target != NONE) addVal(nlohmann::json(val));
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::number_integer(number_integer_t val) {
+  if (_target != NONE) addVal(nlohmann::json(val));
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::number_unsigned(number_unsigned_t val) {
+  if (_target != NONE) addVal(nlohmann::json(val));
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::number_float(number_float_t val, const string_t& s) {
+  (void)s;
+  if (_target != NONE) addVal(nlohmann::json(val));
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::string(string_t& val) {
+  if (_target != NONE) {
+    addVal(nlohmann::json(std::move(val)));
+  } else if (_depth == 1 && _topKey == "type") {
+    _type = val;
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::binary(binary_t& val) {
+  if (_target != NONE) addVal(nlohmann::json(std::move(val)));
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::start_object(std::size_t elements) {
+  (void)elements;
+  if (_target == NONE) {
+    if (_depth == 2 && _inFeatures) {
+      _target = FEATURE;
+    } else if (_depth == 1 && _topKey == "properties") {
+      _target = PROPS;
+    }
+  }
+
+  if (_target != NONE) startContainer(nlohmann::json::object());
+  _depth++;
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::key(string_t& val) {
+  if (_target != NONE) {
+    _key = val;
+  } else if (_depth == 1) {
+    _topKey = val;
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::end_object() {
+  _depth--;
+  if (_target != NONE) endContainer();
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::start_array(std::size_t elements) {
+  (void)elements;
+  if (_target != NONE) {
+    startContainer(nlohmann::json::array());
+  } else if (_depth == 1 && _topKey == "features") {
+    _inFeatures = true;
+  }
+  _depth++;
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::end_array() {
+  _depth--;
+  if (_target != NONE) {
+    endContainer();
+  } else if (_depth == 1) {
+    _inFeatures = false;
+  }
+  return true;
+}
+
+// _____________________________________________________________________________
+bool GeoJsonSaxHandler::parse_error(std::size_t position,
+                                    const std::string& lastToken,
+                                    const nlohmann::detail::exception& ex) {
+  (void)position;
+  (void)lastToken;
+  throw std::runtime_error(ex.what());
+}
+
+// _____________________________________________________________________________
+nlohmann::json* GeoJsonSaxHandler::addVal(nlohmann::json&& val) {
+  if (_stack.empty()) {
+    _cur = std::move(val);
+    return &_cur;
+  }
+
+  nlohmann::json* top = _stack.back();
+
+  if (top->is_array()) {
+    top->push_back(std::move(val));
+    return &top->back();
+  }
+
+  nlohmann::json& ref = (*top)[_key];
+  ref = std::move(val);
+  return &ref;
+}
+
+// _____________________________________________________________________________
+void GeoJsonSaxHandler::startContainer(nlohmann::json&& val) {
+  _stack.push_back(addVal(std::move(val)));
+}
+
+// _____________________________________________________________________________
+void GeoJsonSaxHandler::endContainer() {
+  _stack.pop_back();
+  if (!_stack.empty()) return;
+
+  if (_target == FEATURE) {
+    _featureCb(_cur);
+  } else {
+    _propsCb(_cur);
+  }
+
+  _cur = nlohmann::json();
+  _target = NONE;
+}
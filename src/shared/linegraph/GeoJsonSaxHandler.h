@@ -0,0 +1,74 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef SHARED_LINEGRAPH_GEOJSONSAXHANDLER_H_
+#define SHARED_LINEGRAPH_GEOJSONSAXHANDLER_H_
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "3rdparty/json.hpp"
+
+namespace shared {
+namespace linegraph {
+
+typedef std::function<void(nlohmann::json&)> FeatureCb;
+typedef std::function<void(nlohmann::json&)> PropsCb;
+
+/*
+ * SAX handler for GeoJSON FeatureCollections. Only a single feature is ever
+ * materialized as a DOM: each element of the top-level "features" array is
+ * handed to the feature callback as soon as it is complete and discarded
+ * afterwards. The top-level "properties" object is handed to the properties
+ * callback, everything else on the top level is skipped.
+ */
+class GeoJsonSaxHandler : public nlohmann::json_sax<nlohmann::json> {
+ public:
+  GeoJsonSaxHandler(FeatureCb featureCb, PropsCb propsCb)
+      : _featureCb(featureCb), _propsCb(propsCb){};
+
+  bool null() override;
+  bool boolean(bool val) override;
+  bool number_integer(number_integer_t val) override;
+  bool number_unsigned(number_unsigned_t val) override;
+  bool number_float(number_float_t val, const string_t& s) override;
+  bool string(string_t& val) override;
+  bool binary(binary_t& val) override;
+  bool start_object(std::size_t elements) override;
+  bool key(string_t& val) override;
+  bool end_object() override;
+  bool start_array(std::size_t elements) override;
+  bool end_array() override;
+  bool parse_error(std::size_t position, const std::string& lastToken,
+                   const nlohmann::detail::exception& ex) override;
+
+  // value of the top-level "type" member
+  const std::string& getType() const { return _type; }
+
+ private:
+  enum Target { NONE, FEATURE, PROPS };
+
+  FeatureCb _featureCb;
+  PropsCb _propsCb;
+
+  std::string _type;
+  std::string _topKey;
+  bool _inFeatures = false;
+  size_t _depth = 0;
+
+  Target _target = NONE;
+  nlohmann::json _cur;
+  std::vector<nlohmann::json*> _stack;
+  std::string _key;
+
+  nlohmann::json* addVal(nlohmann::json&& val);
+  void startContainer(nlohmann::json&& val);
+  void endContainer();
+};
+
+}  // namespace linegraph
+}  // namespace shared
+
+#endif  // SHARED_LINEGRAPH_GEOJSONSAXHANDLER_H_
@@ -2,9 +2,26 @@
 // Chair of Algorithms and Data Structures.
 // Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
 #include "3rdparty/json.hpp"
+#include "shared/linegraph/GeoJsonSaxHandler.h"
 #include "shared/linegraph/LineEdgePL.h"
 #include "shared/linegraph/LineGraph.h"
+#include "shared/linegraph/LineGraphBin.h"
 #include "shared/linegraph/LineNodePL.h"
 #include "shared/style/LineStyle.h"
 #include "util/Misc.h"
@@ -16,6 +33,7 @@
 
 using shared::linegraph::EdgeGrid;
 using shared::linegraph::EdgeOrdering;
+using shared::linegraph::GeoJsonSaxHandler;
 using shared::linegraph::ISect;
 using shared::linegraph::Line;
 using shared::linegraph::LineEdge;
@@ -24,7 +42,6 @@ using shared::linegraph::LineNode;
 using shared::linegraph::LineOcc;
 using shared::linegraph::NodeGrid;
 using shared::linegraph::Partner;
-using util::randomHtmlColor;
 using util::geo::DPoint;
 using util::geo::Point;
 using util::graph::Algorithm;
@@ -32,6 +49,28 @@ using util::WARN;
 using util::DEBUG;
 using util::ERROR;
 
+namespace {
+// _____________________________________________________________________________
+std::string randomHtmlColor(std::mt19937_64& rng) {
+  // the palette of util::randomHtmlColor(): a random hue at saturation 0.5
+  // and value 0.95, but drawn from the given engine
+  double h = std::uniform_real_distribution<double>(0, 6)(rng);
+  double s = 0.5, v = 0.95;
+  double f = h - std::floor(h);
+  double p = v * (1 - s), q = v * (1 - s * f), t = v * (1 - s * (1 - f));
+  double rgb[6][3] = {{v, t, p}, {q, v, p}, {p, v, t},
+                      {p, q, v}, {t, p, v}, {v, p, q}};
+  const double* c = rgb[static_cast<size_t>(h) % 6];
+
+  std::stringstream ss;
+  ss << std::hex << std::setfill('0');
+  for (size_t i = 0; i < 3; i++) {
+    ss << std::setw(2) << static_cast<int>(c[i] * 255);
+  }
+  return util::normHtmlColor(ss.str());
+}
+}  // namespace
+
 // _____________________________________________________________________________
 void LineGraph::readFromTopoJson(nlohmann::json::array_t objects,
                                  nlohmann::json::array_t arcs,
@@ -60,243 +99,753 @@ void LineGraph::readFromGeoJson(nlohmann::json::array_t features,
 
   std::map<std::string, LineNode*> idMap;
 
-  for (auto feature : features) {
-    auto props = feature["properties"];
-    auto geom = feature["geometry"];
-    if (geom["type"] == "Point") {
-      std::string id;
-      if (props.count("id")) id = props["id"].get<std::string>();
+  for (auto& feature : features) {
+    if (feature["geometry"]["type"] == "Point")
+      addGeoJsonNd(feature, webMercCoords, &idMap);
+  }
+
+  // second pass, edges
+  for (auto& feature : features) {
+    if (feature["geometry"]["type"] == "LineString")
+      addGeoJsonEdg(feature, webMercCoords, &idMap);
+  }
 
-      std::vector<double> coords = geom["coordinates"];
+  // third pass, exceptions (TODO: do this in the first part, store in some
+  // data structure, add here!)
+  for (auto& feature : features) {
+    if (feature["geometry"]["type"] == "Point")
+      addGeoJsonExcs(feature, webMercCoords, idMap);
+  }
 
-      util::geo::DPoint point(coords[0], coords[1]);
-      if (!webMercCoords) point = util::geo::latLngToWebMerc(point);
+  _bbox = util::geo::pad(_bbox, 100);
 
-      if (id.empty()) {
-        id = std::to_string(static_cast<int>(point.getX())) + "|" +
-             std::to_string(static_cast<int>(point.getY()));
-      }
+  buildGrids();
+}
 
-      if (idMap.count(id)) continue;
+// _____________________________________________________________________________
+void LineGraph::addGeoJsonNd(nlohmann::json& feature, bool webMercCoords,
+                             std::map<std::string, LineNode*>* idMap) {
+  auto& props = feature["properties"];
+  auto& geom = feature["geometry"];
+  std::string id;
+  if (props.count("id")) id = props["id"].get<std::string>();
 
-      LineNode* n = addNd({point, std::numeric_limits<uint32_t>::max()});
-      expandBBox(*n->pl().getGeom());
+  std::vector<double> coords = geom["coordinates"];
 
-      if (props["component"].is_number())
-        n->pl().setComponent(props["component"].get<size_t>());
+  util::geo::DPoint point(coords[0], coords[1]);
+  if (!webMercCoords) point = util::geo::latLngToWebMerc(point);
 
-      Station i("", "", *n->pl().getGeom());
+  if (id.empty()) {
+    id = std::to_string(static_cast<int>(point.getX())) + "|" +
+         std::to_string(static_cast<int>(point.getY()));
+  }
 
-      std::string sid = getStationId(props);
-      std::string label = getStationLabel(props);
-      if (!sid.empty() || !label.empty()) {
-        i.id = sid;
-        i.name = label;
+  if (idMap->count(id)) return;
 
-        n->pl().addStop(i);
-      }
+  LineNode* n = addNd({point, std::numeric_limits<uint32_t>::max()});
+  expandBBox(*n->pl().getGeom());
+
+  if (props["component"].is_number())
+    n->pl().setComponent(props["component"].get<size_t>());
+
+  Station i("", "", *n->pl().getGeom());
+
+  std::string sid = getStationId(props);
+  std::string label = getStationLabel(props);
+  if (!sid.empty() || !label.empty()) {
+    i.id = sid;
+    i.name = label;
+
+    n->pl().addStop(i);
+  }
+
+  (*idMap)[id] = n;
+}
 
-      idMap[id] = n;
+// _____________________________________________________________________________
+bool LineGraph::geoJsonEdgResolvable(
+    nlohmann::json& props,
+    const std::map<std::string, LineNode*>& idMap) const {
+  // edges without explicit node ids create nodes at their end points, which
+  // must not shadow point features still to come
+  if (props["from"].is_null() || props["to"].is_null()) return false;
+  if (!idMap.count(props["from"].get<std::string>())) return false;
+  if (!idMap.count(props["to"].get<std::string>())) return false;
+
+  if (props["lines"].is_array()) {
+    for (const auto& line : props["lines"]) {
+      if (line.count("direction") && line["direction"].is_string() &&
+          !idMap.count(line["direction"].get<std::string>()))
+        return false;
     }
   }
 
-  // second pass, edges
-  for (auto feature : features) {
-    auto props = feature["properties"];
-    auto geom = feature["geometry"];
-    if (geom["type"] == "LineString") {
-      std::string from =
-          props["from"].is_null() ? "" : props["from"].get<std::string>();
-      std::string to =
-          props["to"].is_null() ? "" : props["to"].get<std::string>();
-
-      if (geom["coordinates"].is_null()) continue;
-
-      std::vector<std::vector<double>> coords = geom["coordinates"];
-
-      size_t component = std::numeric_limits<uint32_t>::max();
-
-      if (props["component"].is_number())
-        component = props["component"].get<size_t>();
-
-      PolyLine<double> pl;
-      for (auto coord : coords) {
-        double x = coord[0], y = coord[1];
-        Point<double> p(x, y);
-        if (!webMercCoords) p = util::geo::latLngToWebMerc(p);
-        pl << p;
-        expandBBox(p);
-      }
+  return true;
+}
 
-      if (from.empty()) {
-        from = std::to_string(static_cast<int>(pl.front().getX())) + "|" +
-               std::to_string(static_cast<int>(pl.front().getY()));
-        if (!idMap.count(from))
-          idMap[from] = addNd({pl.getLine().front(), component});
-      }
+// _____________________________________________________________________________
+void LineGraph::addGeoJsonEdg(nlohmann::json& feature, bool webMercCoords,
+                              std::map<std::string, LineNode*>* idMap) {
+  auto& props = feature["properties"];
+  auto& geom = feature["geometry"];
+  std::string from =
+      props["from"].is_null() ? "" : props["from"].get<std::string>();
+  std::string to =
+      props["to"].is_null() ? "" : props["to"].get<std::string>();
+
+  if (geom["coordinates"].is_null()) return;
+
+  std::vector<std::vector<double>> coords = geom["coordinates"];
+
+  size_t component = std::numeric_limits<uint32_t>::max();
+
+  if (props["component"].is_number())
+    component = props["component"].get<size_t>();
+
+  PolyLine<double> pl;
+  for (auto coord : coords) {
+    double x = coord[0], y = coord[1];
+    Point<double> p(x, y);
+    if (!webMercCoords) p = util::geo::latLngToWebMerc(p);
+    pl << p;
+    expandBBox(p);
+  }
+
+  if (from.empty()) {
+    from = std::to_string(static_cast<int>(pl.front().getX())) + "|" +
+           std::to_string(static_cast<int>(pl.front().getY()));
+    if (!idMap->count(from))
+      (*idMap)[from] = addNd({pl.getLine().front(), component});
+  }
+
+  if (to.empty()) {
+    to = std::to_string(static_cast<int>(pl.back().getX())) + "|" +
+         std::to_string(static_cast<int>(pl.back().getY()));
+    if (!idMap->count(to))
+      (*idMap)[to] = addNd({pl.getLine().back(), component});
+  }
+
+  // pl.applyChaikinSmooth(3);
+
+  LineNode* fromN = 0;
+  LineNode* toN = 0;
+
+  if (from.size()) {
+    fromN = (*idMap)[from];
+    if (!fromN) {
+      LOG(ERROR) << "Node \"" << from << "\" not found.";
+      return;
+    }
+  } else {
+    fromN = addNd({pl.getLine().front(), component});
+  }
+
+  if (to.size()) {
+    toN = (*idMap)[to];
+    if (!toN) {
+      LOG(ERROR) << "Node \"" << to << "\" not found.";
+      return;
+    }
+  } else {
+    toN = addNd({pl.getLine().back(), component});
+  }
+
+  if (fromN == toN) {
+    LOGTO(DEBUG, std::cerr) << "Self edges are not supported, dropping...";
+    return;
+  }
+
+  LineEdge* e = addEdg(fromN, toN, pl);
+
+  e->pl().setComponent(component);
+
+  if (props["dontcontract"].is_number() && props["dontcontract"].get<int>())
+    e->pl().setDontContract(true);
 
-      if (to.empty()) {
-        to = std::to_string(static_cast<int>(pl.back().getX())) + "|" +
-             std::to_string(static_cast<int>(pl.back().getY()));
-        if (!idMap.count(to))
-          idMap[to] = addNd({pl.getLine().back(), component});
+  extractLines(props, e, *idMap);
+
+  // if no lines were extracted, completely delete edge
+  if (e->pl().getLines().empty()) delEdg(e->getFrom(), e->getTo());
+}
+
+// _____________________________________________________________________________
+void LineGraph::addGeoJsonExcs(nlohmann::json& feature, bool webMercCoords,
+                               const std::map<std::string, LineNode*>& idMap) {
+  auto& props = feature["properties"];
+  auto& geom = feature["geometry"];
+  std::string id;
+  if (props.count("id")) id = props["id"].get<std::string>();
+
+  if (id.empty()) {
+    std::vector<double> coords = geom["coordinates"];
+
+    util::geo::DPoint point(coords[0], coords[1]);
+    if (!webMercCoords) point = util::geo::latLngToWebMerc(point);
+
+    id = std::to_string(static_cast<int>(point.getX())) + "|" +
+         std::to_string(static_cast<int>(point.getY()));
+  }
+
+  if (!idMap.count(id)) return;
+  LineNode* n = idMap.at(id);
+
+  if (!props["not_serving"].is_null()) {
+    for (auto excl : props["not_serving"]) {
+      std::string lid = excl.get<std::string>();
+
+      const Line* r = getLine(lid);
+
+      if (!r) {
+        LOG(WARN) << "line " << lid << " marked as not served in in node "
+                  << id << ", but no such line exists.";
+        continue;
       }
 
-      // pl.applyChaikinSmooth(3);
+      n->pl().addLineNotServed(r);
+    }
+  }
 
-      LineNode* fromN = 0;
-      LineNode* toN = 0;
+  if (!props["excluded_conn"].is_null()) {
+    for (auto excl : props["excluded_conn"]) {
+      std::string lid = excl["line"].get<std::string>();
+      std::string nid1 = excl["node_from"].get<std::string>();
+      std::string nid2 = excl["node_to"].get<std::string>();
 
-      if (from.size()) {
-        fromN = idMap[from];
-        if (!fromN) {
-          LOG(ERROR) << "Node \"" << from << "\" not found.";
-          continue;
-        }
-      } else {
-        fromN = addNd({pl.getLine().front(), component});
+      const Line* r = getLine(lid);
+
+      if (!r) {
+        LOG(WARN) << "line connection exclude defined in node " << id
+                  << " for line " << lid << ", but no such line exists.";
+        continue;
       }
 
-      if (to.size()) {
-        toN = idMap[to];
-        if (!toN) {
-          LOG(ERROR) << "Node \"" << to << "\" not found.";
-          continue;
-        }
-      } else {
-        toN = addNd({pl.getLine().back(), component});
+      if (!idMap.count(nid1)) {
+        LOG(WARN) << "line connection exclude defined in node " << id
+                  << " for edge from " << nid1
+                  << ", but no such node exists.";
+        continue;
       }
 
-      if (fromN == toN) {
-        LOGTO(DEBUG, std::cerr) << "Self edges are not supported, dropping...";
+      if (!idMap.count(nid2)) {
+        LOG(WARN) << "line connection exclude defined in node " << id
+                  << " for edge from " << nid2
+                  << ", but no such node exists.";
         continue;
       }
 
-      LineEdge* e = addEdg(fromN, toN, pl);
+      LineNode* n1 = idMap.at(nid1);
+      LineNode* n2 = idMap.at(nid2);
 
-      e->pl().setComponent(component);
+      LineEdge* a = getEdg(n, n1);
+      LineEdge* b = getEdg(n, n2);
 
-      if (props["dontcontract"].is_number() && props["dontcontract"].get<int>())
-        e->pl().setDontContract(true);
+      if (!a) {
+        LOG(WARN) << "line connection exclude defined in node " << id
+                  << " for edge from " << nid1
+                  << ", but no such edge exists.";
+        continue;
+      }
 
-      extractLines(props, e, idMap);
+      if (!b) {
+        LOG(WARN) << "line connection exclude defined in node " << id
+                  << " for edge from " << nid2
+                  << ", but no such edge exists.";
+        continue;
+      }
 
-      // if no lines were extracted, completely delete edge
-      if (e->pl().getLines().empty()) delEdg(e->getFrom(), e->getTo());
+      n->pl().addConnExc(r, a, b);
     }
   }
+}
 
-  // third pass, exceptions (TODO: do this in the first part, store in some
-  // data structure, add here!)
-  for (auto feature : features) {
-    auto props = feature["properties"];
-    auto geom = feature["geometry"];
-    if (geom["type"] == "Point") {
-      std::string id;
-      if (props.count("id")) id = props["id"].get<std::string>();
+// _____________________________________________________________________________
+void LineGraph::readFromJson(std::istream* s) { return readFromJson(s, false); }
 
-      if (id.empty()) {
-        std::vector<double> coords = geom["coordinates"];
+// _____________________________________________________________________________
+void LineGraph::readFromJson(std::istream* s, bool useWebMercCoords) {
+  // stream the document feature by feature instead of building a DOM of the
+  // whole input first. Nodes are added as soon as they arrive, edges which
+  // reference nodes not seen yet and the line exceptions (which need all
+  // edges) are held back until the end of the document.
+  _bbox = util::geo::Box<double>();
 
-        util::geo::DPoint point(coords[0], coords[1]);
-        if (!webMercCoords) point = util::geo::latLngToWebMerc(point);
+  std::map<std::string, LineNode*> idMap;
+  std::vector<nlohmann::json> pendingEdgs;
+  std::vector<nlohmann::json> pendingExcs;
+
+  GeoJsonSaxHandler handler(
+      [&](nlohmann::json& feature) {
+        auto& props = feature["properties"];
+        auto& geom = feature["geometry"];
+        if (geom["type"] == "Point") {
+          addGeoJsonNd(feature, useWebMercCoords, &idMap);
+          if (!props["not_serving"].is_null() ||
+              !props["excluded_conn"].is_null())
+            pendingExcs.push_back(std::move(feature));
+        } else if (geom["type"] == "LineString") {
+          if (geoJsonEdgResolvable(props, idMap)) {
+            addGeoJsonEdg(feature, useWebMercCoords, &idMap);
+          } else {
+            pendingEdgs.push_back(std::move(feature));
+          }
+        }
+      },
+      [&](nlohmann::json& props) { _graphProps = props; });
 
-        id = std::to_string(static_cast<int>(point.getX())) + "|" +
-             std::to_string(static_cast<int>(point.getY()));
-      }
+  nlohmann::json::sax_parse(*s, &handler);
 
-      if (!idMap.count(id)) continue;
-      LineNode* n = idMap[id];
+  if (handler.getType() == "Topology") {
+    readFromTopoJson(nlohmann::json::array_t(), nlohmann::json::array_t(),
+                     useWebMercCoords);
+  }
 
-      if (!props["not_serving"].is_null()) {
-        for (auto excl : props["not_serving"]) {
-          std::string lid = excl.get<std::string>();
+  for (auto& feature : pendingEdgs)
+    addGeoJsonEdg(feature, useWebMercCoords, &idMap);
 
-          const Line* r = getLine(lid);
+  for (auto& feature : pendingExcs)
+    addGeoJsonExcs(feature, useWebMercCoords, idMap);
 
-          if (!r) {
-            LOG(WARN) << "line " << lid << " marked as not served in in node "
-                      << id << ", but no such line exists.";
-            continue;
-          }
+  _bbox = util::geo::pad(_bbox, 100);
 
-          n->pl().addLineNotServed(r);
-        }
-      }
+  buildGrids();
+}
 
-      if (!props["excluded_conn"].is_null()) {
-        for (auto excl : props["excluded_conn"]) {
-          std::string lid = excl["line"].get<std::string>();
-          std::string nid1 = excl["node_from"].get<std::string>();
-          std::string nid2 = excl["node_to"].get<std::string>();
+// _____________________________________________________________________________
+void LineGraph::readFromJsonCached(const std::string& json,
+                                   const std::string& binPath) {
+  std::stringstream ss(json);
 
-          const Line* r = getLine(lid);
+  if (binPath.empty()) return readFromJson(&ss);
 
-          if (!r) {
-            LOG(WARN) << "line connection exclude defined in node " << id
-                      << " for line " << lid << ", but no such line exists.";
-            continue;
-          }
+  uint64_t hash = std::hash<std::string>()(json);
+  if (!hash) hash = 1;
 
-          if (!idMap.count(nid1)) {
-            LOG(WARN) << "line connection exclude defined in node " << id
-                      << " for edge from " << nid1
-                      << ", but no such node exists.";
-            continue;
-          }
+  if (readFromBinary(binPath, hash)) {
+    LOGTO(DEBUG, std::cerr) << "Read graph from binary file " << binPath;
+    return;
+  }
 
-          if (!idMap.count(nid2)) {
-            LOG(WARN) << "line connection exclude defined in node " << id
-                      << " for edge from " << nid2
-                      << ", but no such node exists.";
-            continue;
-          }
+  readFromJson(&ss);
 
-          LineNode* n1 = idMap[nid1];
-          LineNode* n2 = idMap[nid2];
+  if (!writeToBinary(binPath, hash)) {
+    LOG(WARN) << "Could not write binary graph file " << binPath;
+  }
+}
 
-          LineEdge* a = getEdg(n, n1);
-          LineEdge* b = getEdg(n, n2);
+// _____________________________________________________________________________
+bool LineGraph::writeToBinary(const std::string& path, uint64_t srcHash) const {
+  std::ofstream f(path, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!f.good()) return false;
+  writeToBinary(&f, srcHash);
+  return f.good();
+}
 
-          if (!a) {
-            LOG(WARN) << "line connection exclude defined in node " << id
-                      << " for edge from " << nid1
-                      << ", but no such edge exists.";
-            continue;
-          }
+// _____________________________________________________________________________
+void LineGraph::writeToBinary(std::ostream* s, uint64_t srcHash) const {
+  std::vector<std::string> strs;
+  std::unordered_map<std::string, uint32_t> strIds;
+
+  std::unordered_map<const LineNode*, uint32_t> ndIds;
+  std::unordered_map<const LineEdge*, uint32_t> edgIds;
+  std::unordered_map<const Line*, uint32_t> lineIds;
+
+  std::vector<bin::LineRec> lines;
+  std::vector<bin::NodeRec> nds;
+  std::vector<bin::StationRec> stations;
+  std::vector<uint32_t> notServed;
+  std::vector<bin::ConnExcRec> connExcs;
+  std::vector<bin::EdgeRec> edgs;
+  std::vector<double> coords;
+  std::vector<bin::LineOccRec> lineOccs;
+
+  auto strId = [&](const std::string& str) {
+    auto i = strIds.find(str);
+    if (i != strIds.end()) return i->second;
+    strIds[str] = strs.size();
+    strs.push_back(str);
+    return static_cast<uint32_t>(strs.size() - 1);
+  };
+
+  auto lineId = [&](const Line* l) {
+    auto i = lineIds.find(l);
+    if (i != lineIds.end()) return i->second;
+    lineIds[l] = lines.size();
+    lines.push_back({strId(l->id()), strId(l->label()), strId(l->color())});
+    return static_cast<uint32_t>(lines.size() - 1);
+  };
+
+  for (const auto& l : _lines) lineId(l.second);
 
-          if (!b) {
-            LOG(WARN) << "line connection exclude defined in node " << id
-                      << " for edge from " << nid2
-                      << ", but no such edge exists.";
-            continue;
-          }
+  for (auto nd : getNds()) {
+    uint32_t ndId = ndIds.size();
+    ndIds[nd] = ndId;
+    for (auto e : nd->getAdjList()) {
+      if (e->getFrom() != nd) continue;
+      uint32_t edgId = edgIds.size();
+      edgIds[e] = edgId;
+    }
+  }
 
-          n->pl().addConnExc(r, a, b);
+  for (auto nd : getNds()) {
+    bin::NodeRec rec;
+    rec.x = nd->pl().getGeom()->getX();
+    rec.y = nd->pl().getGeom()->getY();
+    rec.comp = nd->pl().getComponent();
+    rec.pad = 0;
+
+    rec.firstStation = stations.size();
+    for (const auto& stop : nd->pl().stops()) {
+      stations.push_back(
+          {stop.pos.getX(), stop.pos.getY(), strId(stop.id), strId(stop.name)});
+    }
+    rec.numStations = stations.size() - rec.firstStation;
+
+    rec.firstNotServed = notServed.size();
+    for (auto l : nd->pl().getLinesNotServed()) notServed.push_back(lineId(l));
+    rec.numNotServed = notServed.size() - rec.firstNotServed;
+
+    rec.firstConnExc = connExcs.size();
+    for (const auto& ex : nd->pl().getConnExc()) {
+      for (const auto& exFr : ex.second) {
+        if (!edgIds.count(exFr.first)) continue;
+        for (auto exTo : exFr.second) {
+          if (!edgIds.count(exTo)) continue;
+          connExcs.push_back({lineId(ex.first), edgIds.at(exFr.first),
+                              edgIds.at(exTo)});
         }
       }
     }
+    rec.numConnExcs = connExcs.size() - rec.firstConnExc;
+
+    nds.push_back(rec);
   }
 
-  _bbox = util::geo::pad(_bbox, 100);
+  for (auto nd : getNds()) {
+    for (auto e : nd->getAdjList()) {
+      if (e->getFrom() != nd) continue;
+      bin::EdgeRec rec;
+      rec.from = ndIds.at(e->getFrom());
+      rec.to = ndIds.at(e->getTo());
+      rec.comp = e->pl().getComponent();
+      rec.dontContract = e->pl().dontContract();
+      rec.pad = 0;
+
+      rec.firstCoord = coords.size() / 2;
+      for (const auto& p : *e->pl().getGeom()) {
+        coords.push_back(p.getX());
+        coords.push_back(p.getY());
+      }
+      rec.numCoords = coords.size() / 2 - rec.firstCoord;
+
+      rec.firstLineOcc = lineOccs.size();
+      for (const auto& lo : e->pl().getLines()) {
+        bin::LineOccRec occ;
+        occ.line = lineId(lo.line);
+        occ.direction = lo.direction ? ndIds.at(lo.direction) : bin::NONE;
+        occ.css = bin::NONE;
+        occ.outlineCss = bin::NONE;
+        if (!lo.style.isNull()) {
+          occ.css = strId(lo.style.get().getCss());
+          occ.outlineCss = strId(lo.style.get().getOutlineCss());
+        }
+        lineOccs.push_back(occ);
+      }
+      rec.numLineOccs = lineOccs.size() - rec.firstLineOcc;
 
-  buildGrids();
+      edgs.push_back(rec);
+    }
+  }
+
+  bin::Header h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, bin::MAGIC, sizeof(h.magic));
+  h.version = bin::VERSION;
+  h.graphProps = strId(nlohmann::json(_graphProps).dump());
+  h.srcHash = srcHash;
+  h.bbox[0] = _bbox.getLowerLeft().getX();
+  h.bbox[1] = _bbox.getLowerLeft().getY();
+  h.bbox[2] = _bbox.getUpperRight().getX();
+  h.bbox[3] = _bbox.getUpperRight().getY();
+
+  std::vector<uint64_t> strOffsets(1, 0);
+  for (const auto& str : strs)
+    strOffsets.push_back(strOffsets.back() + str.size());
+
+  h.count[bin::STRINGS] = strs.size();
+  h.count[bin::LINES] = lines.size();
+  h.count[bin::NODES] = nds.size();
+  h.count[bin::STATIONS] = stations.size();
+  h.count[bin::NOT_SERVED] = notServed.size();
+  h.count[bin::CONN_EXCS] = connExcs.size();
+  h.count[bin::EDGES] = edgs.size();
+  h.count[bin::COORDS] = coords.size() / 2;
+  h.count[bin::LINE_OCCS] = lineOccs.size();
+
+  const size_t sizes[bin::NUM_SECTIONS] = {
+      strOffsets.size() * sizeof(uint64_t) + strOffsets.back(),
+      lines.size() * sizeof(bin::LineRec),
+      nds.size() * sizeof(bin::NodeRec),
+      stations.size() * sizeof(bin::StationRec),
+      notServed.size() * sizeof(uint32_t),
+      connExcs.size() * sizeof(bin::ConnExcRec),
+      edgs.size() * sizeof(bin::EdgeRec),
+      coords.size() * sizeof(double),
+      lineOccs.size() * sizeof(bin::LineOccRec)};
+
+  uint64_t off = sizeof(bin::Header);
+  for (size_t i = 0; i < bin::NUM_SECTIONS; i++) {
+    off = (off + 7) & ~static_cast<uint64_t>(7);
+    h.offset[i] = off;
+    off += sizes[i];
+  }
+
+  uint64_t pos = 0;
+  auto write = [&](const void* data, size_t size, uint64_t at) {
+    static const char zeros[8] = {0};
+    s->write(zeros, at - pos);
+    s->write(reinterpret_cast<const char*>(data), size);
+    pos = at + size;
+  };
+
+  write(&h, sizeof(h), 0);
+  write(strOffsets.data(), strOffsets.size() * sizeof(uint64_t),
+        h.offset[bin::STRINGS]);
+  for (const auto& str : strs) write(str.data(), str.size(), pos);
+  write(lines.data(), sizes[bin::LINES], h.offset[bin::LINES]);
+  write(nds.data(), sizes[bin::NODES], h.offset[bin::NODES]);
+  write(stations.data(), sizes[bin::STATIONS], h.offset[bin::STATIONS]);
+  write(notServed.data(), sizes[bin::NOT_SERVED], h.offset[bin::NOT_SERVED]);
+  write(connExcs.data(), sizes[bin::CONN_EXCS], h.offset[bin::CONN_EXCS]);
+  write(edgs.data(), sizes[bin::EDGES], h.offset[bin::EDGES]);
+  write(coords.data(), sizes[bin::COORDS], h.offset[bin::COORDS]);
+  write(lineOccs.data(), sizes[bin::LINE_OCCS], h.offset[bin::LINE_OCCS]);
 }
 
 // _____________________________________________________________________________
-void LineGraph::readFromJson(std::istream* s) { return readFromJson(s, false); }
+bool LineGraph::readFromBinary(const std::string& path, uint64_t srcHash) {
+#ifndef _WIN32
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    return false;
+  }
+
+  void* data = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) return false;
+
+  bool ret = readFromBinary(static_cast<const char*>(data), st.st_size,
+                            srcHash);
+  munmap(data, st.st_size);
+  return ret;
+#else
+  std::ifstream f(path, std::ios::in | std::ios::binary);
+  if (!f.good()) return false;
+  std::vector<char> data((std::istreambuf_iterator<char>(f)),
+                         std::istreambuf_iterator<char>());
+  return readFromBinary(data.data(), data.size(), srcHash);
+#endif
+}
 
 // _____________________________________________________________________________
-void LineGraph::readFromJson(std::istream* s, bool useWebMercCoords) {
-  nlohmann::json j;
-  (*s) >> j;
+bool LineGraph::readFromBinary(const char* data, size_t size,
+                               uint64_t srcHash) {
+  if (size < sizeof(bin::Header)) return false;
+
+  const auto* h = reinterpret_cast<const bin::Header*>(data);
+  if (memcmp(h->magic, bin::MAGIC, sizeof(h->magic)) != 0) return false;
+  if (h->version != bin::VERSION) return false;
+  if (srcHash && h->srcHash != srcHash) return false;
+
+  const size_t recSizes[bin::NUM_SECTIONS] = {
+      sizeof(uint64_t),       sizeof(bin::LineRec),    sizeof(bin::NodeRec),
+      sizeof(bin::StationRec), sizeof(uint32_t),       sizeof(bin::ConnExcRec),
+      sizeof(bin::EdgeRec),    2 * sizeof(double),     sizeof(bin::LineOccRec)};
+
+  for (size_t i = 0; i < bin::NUM_SECTIONS; i++) {
+    if (h->offset[i] % 8 || h->offset[i] > size) return false;
+    // the string offset table has one more entry than there are strings
+    uint64_t n = h->count[i] + (i == bin::STRINGS ? 1 : 0);
+    if (n > (size - h->offset[i]) / recSizes[i]) return false;
+  }
+
+  const uint64_t numStrs = h->count[bin::STRINGS];
+  const auto* strOffs =
+      reinterpret_cast<const uint64_t*>(data + h->offset[bin::STRINGS]);
+  const char* strData = reinterpret_cast<const char*>(strOffs + numStrs + 1);
+
+  // the character data must fit into the file, and the offsets must not run
+  // backwards, otherwise str() below would read past the end
+  size_t strBytes = size - (strData - data);
+  if (strOffs[0] != 0 || strOffs[numStrs] > strBytes) return false;
+  for (uint64_t i = 0; i < numStrs; i++) {
+    if (strOffs[i] > strOffs[i + 1]) return false;
+  }
+
+  auto str = [&](uint32_t id) {
+    return std::string(strData + strOffs[id], strOffs[id + 1] - strOffs[id]);
+  };
+
+  const auto* lineRecs =
+      reinterpret_cast<const bin::LineRec*>(data + h->offset[bin::LINES]);
+  const auto* ndRecs =
+      reinterpret_cast<const bin::NodeRec*>(data + h->offset[bin::NODES]);
+  const auto* statRecs =
+      reinterpret_cast<const bin::StationRec*>(data + h->offset[bin::STATIONS]);
+  const auto* notServedRecs =
+      reinterpret_cast<const uint32_t*>(data + h->offset[bin::NOT_SERVED]);
+  const auto* excRecs = reinterpret_cast<const bin::ConnExcRec*>(
+      data + h->offset[bin::CONN_EXCS]);
+  const auto* edgRecs =
+      reinterpret_cast<const bin::EdgeRec*>(data + h->offset[bin::EDGES]);
+  const auto* coords =
+      reinterpret_cast<const double*>(data + h->offset[bin::COORDS]);
+  const auto* occRecs = reinterpret_cast<const bin::LineOccRec*>(
+      data + h->offset[bin::LINE_OCCS]);
+
+  // check every reference before the graph is touched, a stale or corrupt
+  // cache file is then simply rejected and the source is read instead
+  auto isStr = [&](uint32_t id) { return id < numStrs; };
+  auto inRange = [&](uint64_t first, uint64_t num, bin::Section sec) {
+    return first <= h->count[sec] && num <= h->count[sec] - first;
+  };
+
+  if (!isStr(h->graphProps)) return false;
+
+  for (uint64_t i = 0; i < h->count[bin::LINES]; i++) {
+    const auto& rec = lineRecs[i];
+    if (!isStr(rec.id) || !isStr(rec.label) || !isStr(rec.color)) {
+      return false;
+    }
+  }
+
+  for (uint64_t i = 0; i < h->count[bin::NODES]; i++) {
+    const auto& rec = ndRecs[i];
+    if (!inRange(rec.firstStation, rec.numStations, bin::STATIONS) ||
+        !inRange(rec.firstNotServed, rec.numNotServed, bin::NOT_SERVED) ||
+        !inRange(rec.firstConnExc, rec.numConnExcs, bin::CONN_EXCS)) {
+      return false;
+    }
+  }
+
+  for (uint64_t i = 0; i < h->count[bin::STATIONS]; i++) {
+    if (!isStr(statRecs[i].id) || !isStr(statRecs[i].name)) return false;
+  }
+
+  for (uint64_t i = 0; i < h->count[bin::NOT_SERVED]; i++) {
+    if (notServedRecs[i] >= h->count[bin::LINES]) return false;
+  }
+
+  for (uint64_t i = 0; i < h->count[bin::CONN_EXCS]; i++) {
+    const auto& rec = excRecs[i];
+    if (rec.line >= h->count[bin::LINES] || rec.edgeA >= h->count[bin::EDGES] ||
+        rec.edgeB >= h->count[bin::EDGES]) {
+      return false;
+    }
+  }
+
+  for (uint64_t i = 0; i < h->count[bin::EDGES]; i++) {
+    const auto& rec = edgRecs[i];
+    if (rec.from >= h->count[bin::NODES] || rec.to >= h->count[bin::NODES] ||
+        !inRange(rec.firstCoord, rec.numCoords, bin::COORDS) ||
+        !inRange(rec.firstLineOcc, rec.numLineOccs, bin::LINE_OCCS)) {
+      return false;
+    }
+  }
+
+  for (uint64_t i = 0; i < h->count[bin::LINE_OCCS]; i++) {
+    const auto& occ = occRecs[i];
+    if (occ.line >= h->count[bin::LINES]) return false;
+    if (occ.direction != bin::NONE && occ.direction >= h->count[bin::NODES]) {
+      return false;
+    }
+    if (occ.css != bin::NONE && (!isStr(occ.css) || !isStr(occ.outlineCss))) {
+      return false;
+    }
+  }
+
+  nlohmann::json graphProps;
+  try {
+    graphProps = nlohmann::json::parse(str(h->graphProps));
+  } catch (const std::exception&) {
+    return false;
+  }
+
+  std::vector<const Line*> lines(h->count[bin::LINES]);
+  std::vector<LineNode*> nds(h->count[bin::NODES]);
+  std::vector<LineEdge*> edgs(h->count[bin::EDGES]);
+
+  for (size_t i = 0; i < lines.size(); i++) {
+    std::string id = str(lineRecs[i].id);
+    lines[i] = getLine(id);
+    if (!lines[i]) {
+      lines[i] =
+          new Line(id, str(lineRecs[i].label), str(lineRecs[i].color));
+      addLine(lines[i]);
+    }
+  }
+
+  for (size_t i = 0; i < nds.size(); i++) {
+    const auto& rec = ndRecs[i];
+    nds[i] = addNd({DPoint(rec.x, rec.y), rec.comp});
+    for (size_t j = rec.firstStation; j < rec.firstStation + rec.numStations;
+         j++) {
+      nds[i]->pl().addStop(Station(str(statRecs[j].id), str(statRecs[j].name),
+                                   DPoint(statRecs[j].x, statRecs[j].y)));
+    }
+    for (size_t j = rec.firstNotServed;
+         j < rec.firstNotServed + rec.numNotServed; j++) {
+      nds[i]->pl().addLineNotServed(lines[notServedRecs[j]]);
+    }
+  }
+
+  for (size_t i = 0; i < edgs.size(); i++) {
+    const auto& rec = edgRecs[i];
+    PolyLine<double> pl;
+    for (size_t j = rec.firstCoord; j < rec.firstCoord + rec.numCoords; j++) {
+      pl << DPoint(coords[2 * j], coords[2 * j + 1]);
+    }
+
+    edgs[i] = addEdg(nds[rec.from], nds[rec.to], pl);
+    edgs[i]->pl().setComponent(rec.comp);
+    edgs[i]->pl().setDontContract(rec.dontContract);
+
+    for (size_t j = rec.firstLineOcc; j < rec.firstLineOcc + rec.numLineOccs;
+         j++) {
+      const auto& occ = occRecs[j];
+      LineNode* dir = occ.direction == bin::NONE ? 0 : nds[occ.direction];
+      if (occ.css == bin::NONE) {
+        edgs[i]->pl().addLine(lines[occ.line], dir);
+      } else {
+        shared::style::LineStyle ls;
+        ls.setCss(str(occ.css));
+        ls.setOutlineCss(str(occ.outlineCss));
+        edgs[i]->pl().addLine(lines[occ.line], dir, ls);
+      }
+    }
+  }
 
-  if (j["type"] == "FeatureCollection") {
-    readFromGeoJson(j["features"], useWebMercCoords);
-    if (j.count("properties")) _graphProps = j["properties"];
+  for (size_t i = 0; i < nds.size(); i++) {
+    const auto& rec = ndRecs[i];
+    for (size_t j = rec.firstConnExc; j < rec.firstConnExc + rec.numConnExcs;
+         j++) {
+      nds[i]->pl().addConnExc(lines[excRecs[j].line], edgs[excRecs[j].edgeA],
+                              edgs[excRecs[j].edgeB]);
+    }
   }
-  if (j["type"] == "Topology")
-    readFromTopoJson(j["objects"], j["arcs"], useWebMercCoords);
+
+  _graphProps = graphProps;
+
+  _bbox = util::geo::Box<double>();
+  expandBBox(DPoint(h->bbox[0], h->bbox[1]));
+  expandBBox(DPoint(h->bbox[2], h->bbox[3]));
+
+  buildGrids();
+
+  return true;
 }
 
 // _____________________________________________________________________________
@@ -436,12 +985,18 @@ const Line* LineGraph::getLine(const std::string& id) const {
 
 // _____________________________________________________________________________
 void LineGraph::fillMissingColors() {
+  fillMissingColors(std::random_device()());
+}
+
+// _____________________________________________________________________________
+void LineGraph::fillMissingColors(uint64_t seed) {
+  // own engine instead of the global C RNG, so concurrent calls neither race
+  // nor influence each other
+  std::mt19937_64 rng(seed);
+
   for (auto& l : _lines) {
     auto ll = const_cast<Line*>(l.second);
-    if (ll->color().empty()) {
-      std::string c = randomHtmlColor();
-      ll->setColor(c);
-    }
+    if (ll->color().empty()) ll->setColor(randomHtmlColor(rng));
   }
 }
 
@@ -1451,6 +2006,37 @@ std::vector<LineGraph> LineGraph::distConnectedComponents(double d, bool write,
   return ret;
 }
 
+// _____________________________________________________________________________
+void LineGraph::addGraph(const LineGraph& g) {
+  std::unordered_map<LineNode*, LineNode*> nm;
+
+  for (const auto& l : g._lines) addLine(l.second);
+
+  for (auto nd : g.getNds()) {
+    nm[nd] = addNd(nd->pl());
+    expandBBox(*nd->pl().getGeom());
+    _nodeGrid.add(*nd->pl().getGeom(), nm[nd]);
+  }
+
+  for (auto nd : g.getNds()) {
+    for (auto edg : nd->getAdjList()) {
+      if (edg->getFrom() != nd) continue;
+
+      auto newE = addEdg(nm[edg->getFrom()], nm[edg->getTo()], edg->pl());
+      expandBBox(edg->pl().getGeom()->front());
+      expandBBox(edg->pl().getGeom()->back());
+      _edgeGrid.add(*newE->pl().getGeom(), newE);
+
+      for (const auto& lo : edg->pl().getLines()) addLine(lo.line);
+
+      edgeRpl(newE->getFrom(), edg, newE);
+      edgeRpl(newE->getTo(), edg, newE);
+      nodeRpl(newE, edg->getTo(), nm[edg->getTo()]);
+      nodeRpl(newE, edg->getFrom(), nm[edg->getFrom()]);
+    }
+  }
+}
+
 // _____________________________________________________________________________
 void LineGraph::snapOrphanStations() {
   double MAXD = 1;
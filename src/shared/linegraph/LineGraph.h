@@ -82,6 +82,18 @@ class LineGraph : public util::graph::UndirGraph<LineNodePL, LineEdgePL> {
                                 nlohmann::json::array_t arc);
 
   virtual void readFromJson(std::istream* s, bool useWebMerc);
+
+  // read the graph from the binary file at binPath if it was written for
+  // the same json input, otherwise parse json and (re)write binPath
+  void readFromJsonCached(const std::string& json, const std::string& binPath);
+
+  // versioned binary format, see LineGraphBin.h. srcHash identifies the
+  // input the graph was built from, a non-zero srcHash given on reading must
+  // match the one given on writing
+  bool writeToBinary(const std::string& path, uint64_t srcHash) const;
+  void writeToBinary(std::ostream* s, uint64_t srcHash) const;
+  bool readFromBinary(const std::string& path, uint64_t srcHash);
+  bool readFromBinary(const char* data, size_t size, uint64_t srcHash);
   virtual void readFromGeoJson(nlohmann::json::array_t, bool useWebMerc);
   virtual void readFromTopoJson(nlohmann::json::array_t objects,
                                 nlohmann::json::array_t arc, bool useWebMerc);
@@ -169,7 +181,11 @@ class LineGraph : public util::graph::UndirGraph<LineNodePL, LineEdgePL> {
   std::vector<LineGraph> distConnectedComponents(double d, bool write,
                                                  size_t* offset);
 
+  // copy all nodes, edges and lines of g into this graph
+  void addGraph(const LineGraph& g);
+
   void fillMissingColors();
+  void fillMissingColors(uint64_t seed);
 
   void removeDeg1Nodes();
 
@@ -181,6 +197,17 @@ class LineGraph : public util::graph::UndirGraph<LineNodePL, LineEdgePL> {
   ISect getNextIntersection();
 
   void buildGrids();
+
+  void addGeoJsonNd(nlohmann::json& feature, bool webMercCoords,
+                    std::map<std::string, LineNode*>* idMap);
+  void addGeoJsonEdg(nlohmann::json& feature, bool webMercCoords,
+                     std::map<std::string, LineNode*>* idMap);
+  void addGeoJsonExcs(nlohmann::json& feature, bool webMercCoords,
+                      const std::map<std::string, LineNode*>& idMap);
+  bool geoJsonEdgResolvable(
+      nlohmann::json& props,
+      const std::map<std::string, LineNode*>& idMap) const;
+
   void extractLines(const nlohmann::json::object_t& pars, LineEdge* e,
                     const std::map<std::string, LineNode*>& idMap);
   void extractLine(const nlohmann::json::object_t& pars, LineEdge* e,
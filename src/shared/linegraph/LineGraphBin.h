@@ -0,0 +1,98 @@
+// Copyright 2017, University of Freiburg,
+// Chair of Algorithms and Data Structures.
+// Authors: Patrick Brosi <brosi@informatik.uni-freiburg.de>
+
+#ifndef SHARED_LINEGRAPH_LINEGRAPHBIN_H_
+#define SHARED_LINEGRAPH_LINEGRAPHBIN_H_
+
+#include <cstdint>
+
+namespace shared {
+namespace linegraph {
+namespace bin {
+
+// Binary line graph format. The file is a header followed by the sections
+// below, each starting at an 8 byte aligned offset given in the header. All
+// references between records are indices into the respective sections, so a
+// memory mapped file can be read without any parsing.
+//
+//   strings:   uint64_t offsets[numStrings + 1], then the character data
+//   lines:     LineRec[numLines]
+//   nodes:     NodeRec[numNodes]
+//   stations:  StationRec[numStations]
+//   notServed: uint32_t line[numNotServed]
+//   connExcs:  ConnExcRec[numConnExcs]
+//   edges:     EdgeRec[numEdges]
+//   coords:    double[2 * numCoords], x and y interleaved
+//   lineOccs:  LineOccRec[numLineOccs]
+
+const char MAGIC[8] = {'L', 'O', 'O', 'M', 'G', 'R', 'P', 'H'};
+const uint32_t VERSION = 1;
+const uint32_t NONE = 0xFFFFFFFF;
+
+enum Section {
+  STRINGS = 0,
+  LINES,
+  NODES,
+  STATIONS,
+  NOT_SERVED,
+  CONN_EXCS,
+  EDGES,
+  COORDS,
+  LINE_OCCS,
+  NUM_SECTIONS
+};
+
+struct Header {
+  char magic[8];
+  uint32_t version;
+  uint32_t graphProps;  // string id of the JSON dump of the graph props
+  uint64_t srcHash;     // hash of the source the graph was read from, or 0
+  double bbox[4];       // lower left x, y, upper right x, y
+  uint64_t count[NUM_SECTIONS];
+  uint64_t offset[NUM_SECTIONS];
+};
+
+struct LineRec {
+  uint32_t id, label, color;
+};
+
+struct NodeRec {
+  double x, y;
+  uint32_t comp;
+  uint32_t firstStation, numStations;
+  uint32_t firstNotServed, numNotServed;
+  uint32_t firstConnExc, numConnExcs;
+  uint32_t pad;
+};
+
+struct StationRec {
+  double x, y;
+  uint32_t id, name;
+};
+
+struct ConnExcRec {
+  uint32_t line, edgeA, edgeB;
+};
+
+struct EdgeRec {
+  uint64_t firstCoord;
+  uint32_t numCoords;
+  uint32_t from, to;
+  uint32_t comp;
+  uint32_t dontContract;
+  uint32_t firstLineOcc, numLineOccs;
+  uint32_t pad;
+};
+
+struct LineOccRec {
+  uint32_t line;
+  uint32_t direction;  // node id, or NONE if the line runs in both directions
+  uint32_t css, outlineCss;  // string ids, or NONE if there is no style
+};
+
+}  // namespace bin
+}  // namespace linegraph
+}  // namespace shared
+
+#endif  // SHARED_LINEGRAPH_LINEGRAPHBIN_H_
@@ -39,6 +39,14 @@ class RenderGraph : public shared::linegraph::LineGraph {
   RenderGraph(const shared::linegraph::LineGraph& lg, double defLineWidth,
               double defOutlineWidth, double defLineSpace);
 
+  // take over the nodes and edges of lg without copying them
+  RenderGraph(shared::linegraph::LineGraph&& lg, double defLineWidth,
+              double defOutlineWidth, double defLineSpace)
+      : shared::linegraph::LineGraph(std::move(lg)),
+        _defWidth(defLineWidth),
+        _defOutlineWidth(defOutlineWidth),
+        _defSpacing(defLineSpace){};
+
   void writePermutation(const OrderCfg&);
 
   std::vector<shared::rendergraph::InnerGeom> innerGeoms(
@@ -7,10 +7,14 @@
   #include <unistd.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <fstream>
 #include <iostream>
 #include <set>
 #include <string>
+#include <thread>
 
 #include "Topo.h"
 #include "shared/linegraph/LineGraph.h"
@@ -22,41 +26,114 @@
 #include "util/geo/output/GeoGraphJsonOutput.h"
 #include "util/log/Log.h"
 
+using shared::linegraph::LineGraph;
 using util::DEBUG;
 
 // _____________________________________________________________________________
-std::string run_topo(const std::vector<std::string>& args) {
+topo::config::Config read_topo_config(const std::string& json) {
+  std::stringstream configFile(json);
+  topo::config::Config cfg;
+  shared::config::ConfigReader cr;
+  cr.read(&cfg, &configFile,
+          [](topo::config::Config* c) { /* leave defaults */ },
+          topo::config::jsonToConfig);
+  return cfg;
+}
 
-  if (args.size() != 2) {
-    std::cerr << "Usage: module.run( [<graph_json_file>,<config_json_file>])"<< std::endl;
-    return "";
+// statistics counters of a single component
+struct CompStats {
+  size_t iters = 0;
+  double constrT = 0;
+  size_t maxMergedEdgs = 0;
+  size_t totMergedEdgs = 0;
+  size_t totSupportGraphEdgs = 0;
+  size_t numNdsAfter = 0;
+  size_t numStationsAfter = 0;
+  size_t numEdgsAfter = 0;
+  double lenAfter = 0;
+  size_t numConExc = 0;
+};
+
+// _____________________________________________________________________________
+void processComp(LineGraph* tg, const topo::config::Config& cfg,
+                 CompStats* stats) {
+  topo::restr::RestrInferrer ri(&cfg, tg);
+  topo::MapConstructor mc(&cfg, tg);
+  topo::StatInserter si(&cfg, tg);
+
+  size_t statFr = mc.freeze();
+  si.init();
+  mc.averageNodePositions();
+  mc.removeNodeArtifacts(false);
+  mc.cleanUpGeoms();
+
+  ri.init();
+  size_t restrFr = mc.freeze();
+
+  mc.removeEdgeArtifacts();
+
+  T_START(construction);
+  stats->iters += mc.collapseShrdSegs(10, 50, cfg.segmentLength);
+  stats->iters +=
+      mc.collapseShrdSegs(cfg.maxAggrDistance, 50, cfg.segmentLength);
+  stats->constrT += T_STOP(construction);
+
+  mc.removeNodeArtifacts(false);
+
+  if (cfg.outputStats) {
+    const auto& origEdgs = mc.freezeTrack(restrFr);
+    for (const auto& nd : tg->getNds()) {
+      for (const auto& e : nd->getAdjList()) {
+        if (e->getFrom() != nd) continue;
+        size_t cur = origEdgs.at(e).size();
+        if (cur > stats->maxMergedEdgs) stats->maxMergedEdgs = cur;
+        stats->totMergedEdgs += cur;
+        stats->totSupportGraphEdgs++;
+      }
+    }
   }
 
-  std::stringstream graphStream(args[0]);
-  std::stringstream configFile(args[1]);
+  mc.reconstructIntersections();
+  if (!cfg.noInferRestrs) ri.infer(mc.freezeTrack(restrFr));
+  mc.removeOrphanLines();
+  mc.removeNodeArtifacts(true);
+  mc.reconstructIntersections();
+  mc.removeOrphanLines();
 
-  // initialize randomness
-  srand(time(NULL) + rand());
+  if (cfg.outputStats) {
+    for (const auto& nd : tg->getNds()) {
+      stats->numNdsAfter++;
+      if (nd->pl().stops().size()) stats->numStationsAfter++;
+      for (const auto& e : nd->getAdjList()) {
+        if (e->getFrom() != nd) continue;
+        stats->lenAfter += e->pl().getPolyline().getLength();
+        stats->numEdgsAfter++;
+      }
+    }
+  }
 
-  topo::config::Config cfg;
+  stats->numConExc += tg->numConnExcs();
+
+  if (cfg.smooth > 0) tg->smooth(cfg.smooth);
+}
+
+// _____________________________________________________________________________
+LineGraph run_topo(LineGraph* lgp, const topo::config::Config& cfg,
+                   util::json::Dict* jsonStats) {
+  auto& lg = *lgp;
 
   size_t iters = 0;
   double constrT = 0;
   double restrT = 0;
   double stationT = 0;
 
-  shared::linegraph::LineGraph lg;
-  // read config
-  shared::config::ConfigReader cr;
-  cr.read(&cfg, &configFile,
-          [](topo::config::Config* c) { /* leave defaults */ },
-          topo::config::jsonToConfig);
-
-
-  // read input graph
-  lg.readFromJson(&graphStream);
-
-  if (cfg.randomColors) lg.fillMissingColors();
+  if (cfg.randomColors) {
+    if (cfg.randomSeed) {
+      lg.fillMissingColors(cfg.randomSeed);
+    } else {
+      lg.fillMissingColors();
+    }
+  }
 
   // snap orphan stations
   lg.snapOrphanStations();
@@ -111,71 +188,63 @@ std::string run_topo(const std::vector<std::string>& args) {
   LOGTO(DEBUG, std::cerr) << "Broke up input into " << graphs.size()
                           << " components (including single-node components)";
 
-  std::vector<LineGraph*> resultGraphs;
-  size_t compI = 0;
-
-  for (auto& tg : graphs) {
-    LOGTO(DEBUG, std::cerr) << "@ Component" << compI++ << " components";
-
-    topo::restr::RestrInferrer ri(&cfg, &tg);
-    topo::MapConstructor mc(&cfg, &tg);
-    topo::StatInserter si(&cfg, &tg);
-
-    size_t statFr = mc.freeze();
-    si.init();
-    mc.averageNodePositions();
-    mc.removeNodeArtifacts(false);
-    mc.cleanUpGeoms();
-
-    ri.init();
-    size_t restrFr = mc.freeze();
-
-    mc.removeEdgeArtifacts();
-
-    T_START(construction);
-    iters += mc.collapseShrdSegs(10, 50, cfg.segmentLength);
-    iters += mc.collapseShrdSegs(cfg.maxAggrDistance, 50, cfg.segmentLength);
-    constrT += T_STOP(construction);
-
-    mc.removeNodeArtifacts(false);
-
-    if (cfg.outputStats) {
-      const auto& origEdgs = mc.freezeTrack(restrFr);
-      for (const auto& nd : tg.getNds()) {
-        for (const auto& e : nd->getAdjList()) {
-          if (e->getFrom() != nd) continue;
-          size_t cur = origEdgs.at(e).size();
-          if (cur > maxMergedEdgs) maxMergedEdgs = cur;
-          totMergedEdgs += cur;
-          totSupportGraphEdgs++;
-        }
+  // process the components in a worker pool, largest components first. Every
+  // component writes into its own statistics slot, the slots are merged in
+  // component order afterwards, so the result does not depend on scheduling
+  std::vector<CompStats> compStats(graphs.size());
+  std::vector<size_t> order(graphs.size());
+  for (size_t i = 0; i < order.size(); i++) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return graphs[a].getNds().size() > graphs[b].getNds().size();
+  });
+
+  size_t numThreads = cfg.threads;
+  if (numThreads == 0) numThreads = std::thread::hardware_concurrency();
+  numThreads = std::max<size_t>(1, std::min(numThreads, graphs.size()));
+
+  std::atomic<size_t> next(0);
+  std::vector<std::exception_ptr> excs(numThreads);
+
+  auto worker = [&](size_t t) {
+    try {
+      for (size_t i = next++; i < order.size(); i = next++) {
+        LOGTO(DEBUG, std::cerr) << "@ Component " << order[i];
+        processComp(&graphs[order[i]], cfg, &compStats[order[i]]);
       }
+    } catch (...) {
+      excs[t] = std::current_exception();
+      next = order.size();
     }
+  };
 
-    mc.reconstructIntersections();
-    if (!cfg.noInferRestrs) ri.infer(mc.freezeTrack(restrFr));
-    mc.removeOrphanLines();
-    mc.removeNodeArtifacts(true);
-    mc.reconstructIntersections();
-    mc.removeOrphanLines();
-
-    if (cfg.outputStats) {
-      for (const auto& nd : tg.getNds()) {
-        numNdsAfter++;
-        if (nd->pl().stops().size()) numStationsAfter++;
-        for (const auto& e : nd->getAdjList()) {
-          if (e->getFrom() != nd) continue;
-          lenAfter += e->pl().getPolyline().getLength();
-          numEdgsAfter++;
-        }
-      }
-    }
+  if (numThreads == 1) {
+    worker(0);
+  } else {
+    std::vector<std::thread> thrds;
+    for (size_t t = 0; t < numThreads; t++) thrds.emplace_back(worker, t);
+    for (auto& thr : thrds) thr.join();
+  }
 
-    numConExc += tg.numConnExcs();
+  for (const auto& exc : excs) {
+    if (exc) std::rethrow_exception(exc);
+  }
 
-    if (cfg.smooth > 0) tg.smooth(cfg.smooth);
+  std::vector<LineGraph*> resultGraphs;
 
-    resultGraphs.push_back(&tg);
+  for (size_t i = 0; i < graphs.size(); i++) {
+    const auto& cs = compStats[i];
+    iters += cs.iters;
+    constrT += cs.constrT;
+    maxMergedEdgs = std::max(maxMergedEdgs, cs.maxMergedEdgs);
+    totMergedEdgs += cs.totMergedEdgs;
+    totSupportGraphEdgs += cs.totSupportGraphEdgs;
+    numNdsAfter += cs.numNdsAfter;
+    numStationsAfter += cs.numStationsAfter;
+    numEdgsAfter += cs.numEdgsAfter;
+    lenAfter += cs.lenAfter;
+    numConExc += cs.numConExc;
+
+    resultGraphs.push_back(&graphs[i]);
   }
 
   int numComps = 0;
@@ -198,12 +267,8 @@ std::string run_topo(const std::vector<std::string>& args) {
     }
   }
 
-  // output
-  util::geo::output::GeoGraphJsonOutput gout;
-  std::ostringstream outputStream;
-
-  if (cfg.outputStats) {
-    util::json::Dict jsonStats = {
+  if (jsonStats && cfg.outputStats) {
+    *jsonStats = util::json::Dict{
         {"statistics",
          util::json::Dict{
              {"num_edgs_in", numEdgsBef},
@@ -225,14 +290,42 @@ std::string run_topo(const std::vector<std::string>& args) {
              {"tot_merged_edgs", totMergedEdgs},
              {"tot_support_graph_edgs", totSupportGraphEdgs},
          }}};
+  }
+
+  LineGraph ret;
+  for (auto tg : resultGraphs) ret.addGraph(*tg);
+
+  return ret;
+}
+
+// _____________________________________________________________________________
+std::string run_topo(const std::vector<std::string>& args) {
+
+  if (args.size() != 2) {
+    std::cerr << "Usage: module.run( [<graph_json_file>,<config_json_file>])"<< std::endl;
+    return "";
+  }
 
-    util::geo::output::GeoJsonOutput out(outputStream, jsonStats);
-    for (auto gg : resultGraphs) gout.printLatLng(*gg, &out);
-    out.flush();
+  std::stringstream graphStream(args[0]);
+
+  // read config
+  auto cfg = read_topo_config(args[1]);
+
+  // read input graph
+  LineGraph lg;
+  lg.readFromJson(&graphStream);
+
+  util::json::Dict jsonStats;
+  auto res = run_topo(&lg, cfg, &jsonStats);
+
+  // output
+  util::geo::output::GeoGraphJsonOutput gout;
+  std::ostringstream outputStream;
+
+  if (cfg.outputStats) {
+    gout.printLatLng(res, outputStream, jsonStats);
   } else {
-    util::geo::output::GeoJsonOutput out(outputStream);
-    for (auto gg : resultGraphs) gout.printLatLng(*gg, &out);
-    out.flush();
+    gout.printLatLng(res, outputStream);
   }
 
   return outputStream.str();
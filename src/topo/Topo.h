@@ -3,8 +3,15 @@
 
 #include <string>
 #include <vector>
+#include "shared/linegraph/LineGraph.h"
+#include "topo/config/TopoConfig.h"
+#include "util/json/Writer.h"
 
 // Function declarations
+topo::config::Config read_topo_config(const std::string& json);
+shared::linegraph::LineGraph run_topo(shared::linegraph::LineGraph* lg,
+                                      const topo::config::Config& cfg,
+                                      util::json::Dict* stats);
 std::string run_topo(const std::vector<std::string>& args); 
 
 #endif  // TOPO_MAIN_H
\ No newline at end of file
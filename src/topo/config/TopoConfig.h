@@ -23,16 +23,21 @@ struct Config {
   bool noInferRestrs = false;
   bool writeComponents = false;
   bool randomColors = false;
+  uint64_t randomSeed = 0;
   bool aggregateStats = false;
   double connectedCompDist = 10000;
   double smooth = 0;
   std::string componentsPath = "";
+
+  // number of components processed concurrently, 0 for one per core
+  size_t threads = 1;
 };
 
 // JSON -> TopoConfig mapper
 inline void jsonToConfig(const nlohmann::json& jsonObj, Config* cfg) {
   using shared::config::assignIfContains;
   using shared::config::assignIfContainsBool;
+  using shared::config::assignIfContainsCount;
 
   assignIfContains<double>(jsonObj, "max-aggr-dist", [&](double v){ cfg->maxAggrDistance = v; });
   assignIfContainsBool(jsonObj, "no-infer-restrs", [&](bool v){ cfg->noInferRestrs = v; });
@@ -42,11 +47,13 @@ inline void jsonToConfig(const nlohmann::json& jsonObj, Config* cfg) {
   assignIfContains<std::string>(jsonObj, "write-components-path", [&](const std::string& v){ cfg->componentsPath = v; });
   assignIfContains<double>(jsonObj, "turn-restr-full-turn-pen", [&](double v){ cfg->turnInferFullTurnPen = v; });
   assignIfContainsBool(jsonObj, "random-colors", [&](bool v){ cfg->randomColors = v; });
+  assignIfContains<uint64_t>(jsonObj, "random-seed", [&](uint64_t v){ cfg->randomSeed = v; });
   assignIfContains<double>(jsonObj, "sample-dist", [&](double v){ cfg->segmentLength = v; });
   assignIfContains<double>(jsonObj, "max-comp-dist", [&](double v){ cfg->connectedCompDist = v; });
   assignIfContains<double>(jsonObj, "smooth", [&](double v){ cfg->smooth = v; });
   assignIfContains<double>(jsonObj, "turn-restr-full-turn-angle", [&](double v){ cfg->fullTurnAngle = v; });
   assignIfContainsBool(jsonObj, "aggr-stats", [&](bool v){ cfg->aggregateStats = v; });
+  assignIfContainsCount(jsonObj, "threads", [&](size_t v){ cfg->threads = v; });
 }
 
 }  // namespace config